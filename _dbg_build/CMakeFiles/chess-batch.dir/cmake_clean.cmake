@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/chess-batch.dir/demos/chess/tools/batch.cpp.o"
+  "CMakeFiles/chess-batch.dir/demos/chess/tools/batch.cpp.o.d"
+  "chess-batch"
+  "chess-batch.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/chess-batch.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
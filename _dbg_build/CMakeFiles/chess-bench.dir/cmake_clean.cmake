@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/chess-bench.dir/demos/chess/tools/bench.cpp.o"
+  "CMakeFiles/chess-bench.dir/demos/chess/tools/bench.cpp.o.d"
+  "chess-bench"
+  "chess-bench.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/chess-bench.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/chess-pgn.dir/demos/chess/tools/pgn.cpp.o"
+  "CMakeFiles/chess-pgn.dir/demos/chess/tools/pgn.cpp.o.d"
+  "chess-pgn"
+  "chess-pgn.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/chess-pgn.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
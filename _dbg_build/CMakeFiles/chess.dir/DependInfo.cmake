@@ -0,0 +1,32 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/demos/chess/bitboard.cpp" "CMakeFiles/chess.dir/demos/chess/bitboard.cpp.o" "gcc" "CMakeFiles/chess.dir/demos/chess/bitboard.cpp.o.d"
+  "/root/repo/demos/chess/book.cpp" "CMakeFiles/chess.dir/demos/chess/book.cpp.o" "gcc" "CMakeFiles/chess.dir/demos/chess/book.cpp.o.d"
+  "/root/repo/demos/chess/chess.cpp" "CMakeFiles/chess.dir/demos/chess/chess.cpp.o" "gcc" "CMakeFiles/chess.dir/demos/chess/chess.cpp.o.d"
+  "/root/repo/demos/chess/fen.cpp" "CMakeFiles/chess.dir/demos/chess/fen.cpp.o" "gcc" "CMakeFiles/chess.dir/demos/chess/fen.cpp.o.d"
+  "/root/repo/demos/chess/mapped.cpp" "CMakeFiles/chess.dir/demos/chess/mapped.cpp.o" "gcc" "CMakeFiles/chess.dir/demos/chess/mapped.cpp.o.d"
+  "/root/repo/demos/chess/movepicker.cpp" "CMakeFiles/chess.dir/demos/chess/movepicker.cpp.o" "gcc" "CMakeFiles/chess.dir/demos/chess/movepicker.cpp.o.d"
+  "/root/repo/demos/chess/nnue.cpp" "CMakeFiles/chess.dir/demos/chess/nnue.cpp.o" "gcc" "CMakeFiles/chess.dir/demos/chess/nnue.cpp.o.d"
+  "/root/repo/demos/chess/pawns.cpp" "CMakeFiles/chess.dir/demos/chess/pawns.cpp.o" "gcc" "CMakeFiles/chess.dir/demos/chess/pawns.cpp.o.d"
+  "/root/repo/demos/chess/perft.cpp" "CMakeFiles/chess.dir/demos/chess/perft.cpp.o" "gcc" "CMakeFiles/chess.dir/demos/chess/perft.cpp.o.d"
+  "/root/repo/demos/chess/pgn.cpp" "CMakeFiles/chess.dir/demos/chess/pgn.cpp.o" "gcc" "CMakeFiles/chess.dir/demos/chess/pgn.cpp.o.d"
+  "/root/repo/demos/chess/san.cpp" "CMakeFiles/chess.dir/demos/chess/san.cpp.o" "gcc" "CMakeFiles/chess.dir/demos/chess/san.cpp.o.d"
+  "/root/repo/demos/chess/search.cpp" "CMakeFiles/chess.dir/demos/chess/search.cpp.o" "gcc" "CMakeFiles/chess.dir/demos/chess/search.cpp.o.d"
+  "/root/repo/demos/chess/tablebase.cpp" "CMakeFiles/chess.dir/demos/chess/tablebase.cpp.o" "gcc" "CMakeFiles/chess.dir/demos/chess/tablebase.cpp.o.d"
+  "/root/repo/demos/chess/tt.cpp" "CMakeFiles/chess.dir/demos/chess/tt.cpp.o" "gcc" "CMakeFiles/chess.dir/demos/chess/tt.cpp.o.d"
+  )
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
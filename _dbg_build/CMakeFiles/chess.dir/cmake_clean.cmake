@@ -0,0 +1,37 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/chess.dir/demos/chess/bitboard.cpp.o"
+  "CMakeFiles/chess.dir/demos/chess/bitboard.cpp.o.d"
+  "CMakeFiles/chess.dir/demos/chess/book.cpp.o"
+  "CMakeFiles/chess.dir/demos/chess/book.cpp.o.d"
+  "CMakeFiles/chess.dir/demos/chess/chess.cpp.o"
+  "CMakeFiles/chess.dir/demos/chess/chess.cpp.o.d"
+  "CMakeFiles/chess.dir/demos/chess/fen.cpp.o"
+  "CMakeFiles/chess.dir/demos/chess/fen.cpp.o.d"
+  "CMakeFiles/chess.dir/demos/chess/mapped.cpp.o"
+  "CMakeFiles/chess.dir/demos/chess/mapped.cpp.o.d"
+  "CMakeFiles/chess.dir/demos/chess/movepicker.cpp.o"
+  "CMakeFiles/chess.dir/demos/chess/movepicker.cpp.o.d"
+  "CMakeFiles/chess.dir/demos/chess/nnue.cpp.o"
+  "CMakeFiles/chess.dir/demos/chess/nnue.cpp.o.d"
+  "CMakeFiles/chess.dir/demos/chess/pawns.cpp.o"
+  "CMakeFiles/chess.dir/demos/chess/pawns.cpp.o.d"
+  "CMakeFiles/chess.dir/demos/chess/perft.cpp.o"
+  "CMakeFiles/chess.dir/demos/chess/perft.cpp.o.d"
+  "CMakeFiles/chess.dir/demos/chess/pgn.cpp.o"
+  "CMakeFiles/chess.dir/demos/chess/pgn.cpp.o.d"
+  "CMakeFiles/chess.dir/demos/chess/san.cpp.o"
+  "CMakeFiles/chess.dir/demos/chess/san.cpp.o.d"
+  "CMakeFiles/chess.dir/demos/chess/search.cpp.o"
+  "CMakeFiles/chess.dir/demos/chess/search.cpp.o.d"
+  "CMakeFiles/chess.dir/demos/chess/tablebase.cpp.o"
+  "CMakeFiles/chess.dir/demos/chess/tablebase.cpp.o.d"
+  "CMakeFiles/chess.dir/demos/chess/tt.cpp.o"
+  "CMakeFiles/chess.dir/demos/chess/tt.cpp.o.d"
+  "libchess.a"
+  "libchess.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/chess.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,94 @@
+#include "bitboard.h"
+
+namespace chess
+{
+
+namespace
+{
+
+// found offline for this board layout (a8 = 0, h1 = 63)
+constexpr std::array<Bitboard, kNumSquares> kBishopMagicNumbers = {
+    // clang-format off
+    0x0020412200850A00ULL, 0x01084108008D0000ULL, 0x0022020052009000ULL, 0x0051041282800408ULL,
+    0x0065114000900001ULL, 0x0025112010005224ULL, 0x1109009004200C00ULL, 0x0051011800840418ULL,
+    0x8032041084010400ULL, 0x6802200104009880ULL, 0x8204480803202A48ULL, 0x5D80441042000100ULL,
+    0x0008084840400418ULL, 0x4010811002100002ULL, 0x0420443202022000ULL, 0x10600A0201010808ULL,
+    0x2048104250040090ULL, 0x8202082004810200ULL, 0x2020401200810600ULL, 0x0C04000840400801ULL,
+    0x0101000820080800ULL, 0x020080051000A002ULL, 0x480402B0414808A0ULL, 0x1031000434821000ULL,
+    0x00500A0040480142ULL, 0x0031201011240100ULL, 0x4400880010002423ULL, 0x2100802012020200ULL,
+    0x0901010043104000ULL, 0x0000C1000A01960CULL, 0x00420400020D4508ULL, 0x0000430022008250ULL,
+    0x010450081040421AULL, 0x4801080800021004ULL, 0x1030109004420400ULL, 0x1000520080280480ULL,
+    0x2010120080001004ULL, 0x001210020A850085ULL, 0x0282080120220080ULL, 0x2844013040020042ULL,
+    0x0004046085280800ULL, 0x0000681410100422ULL, 0x1020202028005000ULL, 0x000204201800BD00ULL,
+    0x0002401812004040ULL, 0x1040210048840100ULL, 0x0008018410944C00ULL, 0x0011080103024248ULL,
+    0x0002011008040000ULL, 0x0800420824020000ULL, 0x0800808048080040ULL, 0x0028112842020202ULL,
+    0x0020006002442100ULL, 0x4880214202120028ULL, 0x0450442188020020ULL, 0x0114D80204202004ULL,
+    0x0020210510112080ULL, 0x2200482088541000ULL, 0x0040100022011000ULL, 0x0480091002460800ULL,
+    0x0C20024004104400ULL, 0x00410C3808101C26ULL, 0x100C1011D1090400ULL, 0x0002100208004080ULL,
+    // clang-format on
+};
+
+constexpr std::array<Bitboard, kNumSquares> kRookMagicNumbers = {
+    // clang-format off
+    0x4080008491604000ULL, 0x0040001000402000ULL, 0x02002080400A0010ULL, 0x4100081000200700ULL,
+    0x0200040200201009ULL, 0x0900010008040002ULL, 0x0400011090380204ULL, 0x0200002410804502ULL,
+    0x0310800040089025ULL, 0x0100400020005000ULL, 0x8021001049002000ULL, 0x8001002100100008ULL,
+    0x0102800400080080ULL, 0x000A00082E00104DULL, 0x0004001842011084ULL, 0x1005000100007082ULL,
+    0x0080208000400084ULL, 0xB000808020004000ULL, 0x0302110045002000ULL, 0x4000848010010800ULL,
+    0x0022020010200408ULL, 0x3501010008040002ULL, 0x000004004810A102ULL, 0x10000200005100A4ULL,
+    0x0510800080204000ULL, 0x0040400080200080ULL, 0x2000110100200040ULL, 0x0080900480080080ULL,
+    0x0001011100080004ULL, 0x044C008080020004ULL, 0x00A021040050A208ULL, 0x0800802180015100ULL,
+    0x180040008180022FULL, 0x0400400080802000ULL, 0x0240450011002000ULL, 0x8010100080800800ULL,
+    0x1000800400800800ULL, 0x0000020080800400ULL, 0x0040880144000230ULL, 0x004100008F002142ULL,
+    0x0000400080088020ULL, 0x0010002000444000ULL, 0x0420001000208080ULL, 0x520010010021000AULL,
+    0x0008000500090010ULL, 0x0002005008A20004ULL, 0x2800821088040001ULL, 0x0840208041020004ULL,
+    0x8011244009800180ULL, 0x0045048026004200ULL, 0x004A002840108600ULL, 0x002A4022000A1200ULL,
+    0x0020080004008080ULL, 0x4401044020100801ULL, 0x004221B008020400ULL, 0x2400364100840200ULL,
+    0x00010229128000C1ULL, 0x0009002010820042ULL, 0x004A200040102903ULL, 0x0C04090004100021ULL,
+    0x4041000208000411ULL, 0x080A000408108102ULL, 0x0800081001020084ULL, 0x6000089025040042ULL,
+    // clang-format on
+};
+
+constexpr int kBishopTableSize = 5248;
+constexpr int kRookTableSize = 102400;
+
+Bitboard BishopAttacks[kBishopTableSize];
+Bitboard RookAttacks[kRookTableSize];
+
+template <typename RayFn>
+std::array<Magic, kNumSquares> InitMagics(const std::array<Bitboard, kNumSquares>& masks,
+                                          const std::array<Bitboard, kNumSquares>& numbers,
+                                          Bitboard* table,
+                                          RayFn ray)
+{
+    std::array<Magic, kNumSquares> magics = {};
+
+    auto offset = 0;
+    for (auto sq = 0; sq < kNumSquares; ++sq)
+    {
+        auto& m = magics[sq];
+        m.mask = masks[sq];
+        m.magic = numbers[sq];
+        m.shift = static_cast<uint8_t>(64 - CountPieces(m.mask));
+        m.attacks = table + offset;
+
+        // walk every subset of the relevant mask (carry-rippler)
+        Bitboard blockers = kEmptyBitboard;
+        do
+        {
+            table[offset + m.Index(blockers)] = ray(sq, blockers);
+            blockers = (blockers - m.mask) & m.mask;
+        } while (blockers);
+
+        offset += 1 << CountPieces(m.mask);
+    }
+
+    return magics;
+}
+
+} // namespace
+
+const std::array<Magic, kNumSquares> BishopMagics = InitMagics(BishopRelevantMasks, kBishopMagicNumbers, BishopAttacks, BishopRayMask);
+const std::array<Magic, kNumSquares> RookMagics = InitMagics(RookRelevantMasks, kRookMagicNumbers, RookAttacks, RookRayMask);
+
+} // namespace chess
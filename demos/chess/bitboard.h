@@ -2,6 +2,7 @@
 
 #include <array>
 #include <bit>
+#include <cstdint>
 
 #include "consts.h"
 
@@ -176,6 +177,91 @@ constexpr auto BlackPawnPushMasks = InitBlackPawnPushMasks();
 constexpr auto BlackPawnDoublePushMasks = InitBlackPawnDoublePushMasks();
 constexpr auto BlackPawnCaptureMasks = InitBlackPawnCaptureMasks();
 
+constexpr Bitboard FileMask(int file)
+{
+    Bitboard mask = kEmptyBitboard;
+    for (auto rank = 0; rank < kNumRanks; ++rank)
+    {
+        mask |= SquareMask(rank, file);
+    }
+    return mask;
+}
+
+constexpr Bitboard AdjacentFilesMask(int square)
+{
+    int file = square % kNumRanks;
+
+    Bitboard mask = kEmptyBitboard;
+    if (file > 0)
+    {
+        mask |= FileMask(file - 1);
+    }
+    if (file < 7)
+    {
+        mask |= FileMask(file + 1);
+    }
+    return mask;
+}
+
+// squares in front of the pawn on its own and the adjacent files, a passed pawn has no enemy pawns there
+constexpr Bitboard PassedPawnMask(int square, bool white)
+{
+    int rank = square / kNumRanks;
+    int file = square % kNumRanks;
+
+    Bitboard mask = kEmptyBitboard;
+    for (auto r = 0; r < kNumRanks; ++r)
+    {
+        if ((white && r >= rank) || (!white && r <= rank))
+        {
+            continue;
+        }
+        for (auto f = file - 1; f <= file + 1; ++f)
+        {
+            if (f >= 0 && f < kNumFiles)
+            {
+                mask |= SquareMask(r, f);
+            }
+        }
+    }
+    return mask;
+}
+
+constexpr auto InitFileMasks(void)
+{
+    std::array<Bitboard, kNumFiles> arr{};
+    for (auto i = 0; i < kNumFiles; ++i)
+    {
+        arr[i] = FileMask(i);
+    }
+    return arr;
+}
+
+constexpr auto InitAdjacentFilesMasks(void)
+{
+    std::array<Bitboard, kNumSquares> arr{};
+    for (auto i = 0; i < kNumSquares; ++i)
+    {
+        arr[i] = AdjacentFilesMask(i);
+    }
+    return arr;
+}
+
+constexpr auto InitPassedPawnMasks(bool white)
+{
+    std::array<Bitboard, kNumSquares> arr{};
+    for (auto i = 0; i < kNumSquares; ++i)
+    {
+        arr[i] = PassedPawnMask(i, white);
+    }
+    return arr;
+}
+
+constexpr auto FileMasks = InitFileMasks();
+constexpr auto AdjacentFilesMasks = InitAdjacentFilesMasks();
+constexpr auto WhitePassedPawnMasks = InitPassedPawnMasks(true);
+constexpr auto BlackPassedPawnMasks = InitPassedPawnMasks(false);
+
 constexpr Bitboard KnightMask(int square)
 {
     Bitboard mask = kEmptyBitboard;
@@ -212,18 +298,14 @@ constexpr auto InitKnightMasks(void)
 
 constexpr auto KnightMasks = InitKnightMasks();
 
-Bitboard BishopMask(int square, const Bitboard blockers)
+constexpr Bitboard SlidingMask(int square, const Bitboard blockers, const std::array<int, 4>& dr, const std::array<int, 4>& df, bool relevant)
 {
-    constexpr int deltas = 4;
-    constexpr std::array<int, deltas> dr = {1, 1, -1, -1};
-    constexpr std::array<int, deltas> df = {1, -1, 1, -1};
-
     Bitboard mask = kEmptyBitboard;
 
     const int rank = square / kNumRanks;
     const int file = square % kNumRanks;
 
-    for (auto dir = 0; dir < deltas; ++dir)
+    for (auto dir = 0; dir < 4; ++dir)
     {
         auto r = rank;
         auto f = file;
@@ -237,6 +319,17 @@ Bitboard BishopMask(int square, const Bitboard blockers)
                 break;
             }
 
+            // the last square of a ray never changes the attack set
+            if (relevant)
+            {
+                auto nr = r + dr[dir];
+                auto nf = f + df[dir];
+                if (nr < 0 || nr >= kNumRanks || nf < 0 || nf >= kNumFiles)
+                {
+                    break;
+                }
+            }
+
             auto sq = r * kNumRanks + f;
             mask |= MaskFromSquare(sq);
 
@@ -250,82 +343,181 @@ Bitboard BishopMask(int square, const Bitboard blockers)
     return mask;
 }
 
-Bitboard RookMask(int square, Bitboard blockers)
+constexpr std::array<int, 4> kBishopDeltaRanks = {1, 1, -1, -1};
+constexpr std::array<int, 4> kBishopDeltaFiles = {1, -1, 1, -1};
+constexpr std::array<int, 4> kRookDeltaRanks = {1, -1, 0, 0};
+constexpr std::array<int, 4> kRookDeltaFiles = {0, 0, 1, -1};
+
+constexpr Bitboard BishopRayMask(int square, const Bitboard blockers)
 {
-    constexpr int deltas = 4;
-    constexpr std::array<int, deltas> dr = {1, -1, 0, 0};
-    constexpr std::array<int, deltas> df = {0, 0, 1, -1};
+    return SlidingMask(square, blockers, kBishopDeltaRanks, kBishopDeltaFiles, false);
+}
 
-    Bitboard mask = kEmptyBitboard;
+constexpr Bitboard RookRayMask(int square, const Bitboard blockers)
+{
+    return SlidingMask(square, blockers, kRookDeltaRanks, kRookDeltaFiles, false);
+}
 
-    const int rank = square / kNumRanks;
-    const int file = square % kNumRanks;
+constexpr auto InitBishopRelevantMasks(void)
+{
+    std::array<Bitboard, kNumSquares> masks = {};
+    for (auto sq = 0; sq < kNumSquares; ++sq)
+    {
+        masks[sq] = SlidingMask(sq, kEmptyBitboard, kBishopDeltaRanks, kBishopDeltaFiles, true);
+    }
+    return masks;
+}
 
-    for (auto dir = 0; dir < deltas; ++dir)
+constexpr auto InitRookRelevantMasks(void)
+{
+    std::array<Bitboard, kNumSquares> masks = {};
+    for (auto sq = 0; sq < kNumSquares; ++sq)
     {
-        auto r = rank;
-        auto f = file;
+        masks[sq] = SlidingMask(sq, kEmptyBitboard, kRookDeltaRanks, kRookDeltaFiles, true);
+    }
+    return masks;
+}
 
-        while (true)
-        {
-            r += dr[dir];
-            f += df[dir];
-            if (r < 0 || r >= kNumRanks || f < 0 || f >= kNumFiles)
-            {
-                break;
-            }
+constexpr auto BishopRelevantMasks = InitBishopRelevantMasks();
+constexpr auto RookRelevantMasks = InitRookRelevantMasks();
 
-            auto sq = r * kNumRanks + f;
-            mask |= MaskFromSquare(sq);
+// fancy magic bitboards, the attack tables are built once in bitboard.cpp
+struct Magic
+{
+    Bitboard mask;
+    Bitboard magic;
+    const Bitboard* attacks;
+    uint8_t shift;
 
-            if (blockers & MaskFromSquare(sq))
-            {
-                break;
-            }
-        }
+    inline Bitboard Index(const Bitboard blockers) const
+    {
+        return ((blockers & mask) * magic) >> shift;
     }
+};
 
-    return mask;
+extern const std::array<Magic, kNumSquares> BishopMagics;
+extern const std::array<Magic, kNumSquares> RookMagics;
+
+inline Bitboard BishopMask(int square, const Bitboard blockers)
+{
+    const auto& m = BishopMagics[square];
+    return m.attacks[m.Index(blockers)];
 }
 
-Bitboard QueenMask(int square, const Bitboard blockers)
+inline Bitboard RookMask(int square, const Bitboard blockers)
 {
-    constexpr int deltas = 8;
-    constexpr std::array<int, deltas> dr = {1, -1, 0, 0, 1, 1, -1, -1};
-    constexpr std::array<int, deltas> df = {0, 0, 1, -1, 1, -1, 1, -1};
+    const auto& m = RookMagics[square];
+    return m.attacks[m.Index(blockers)];
+}
+
+inline Bitboard QueenMask(int square, const Bitboard blockers)
+{
+    return BishopMask(square, blockers) | RookMask(square, blockers);
+}
+
+constexpr Bitboard BetweenMask(int from, int to)
+{
+    const int r0 = from / kNumRanks;
+    const int f0 = from % kNumRanks;
+    const int r1 = to / kNumRanks;
+    const int f1 = to % kNumRanks;
+
+    const int dr = (r1 > r0) - (r1 < r0);
+    const int df = (f1 > f0) - (f1 < f0);
+
+    // only squares on a shared rank, file or diagonal have anything between them
+    if ((from == to) || (r0 != r1 && f0 != f1 && (r1 - r0) * df != (f1 - f0) * dr))
+    {
+        return kEmptyBitboard;
+    }
 
     Bitboard mask = kEmptyBitboard;
+    for (auto r = r0 + dr, f = f0 + df; r != r1 || f != f1; r += dr, f += df)
+    {
+        mask |= SquareMask(r, f);
+    }
+    return mask;
+}
 
-    const int rank = square / kNumRanks;
-    const int file = square % kNumRanks;
+constexpr auto InitBetweenMasks(void)
+{
+    std::array<std::array<Bitboard, kNumSquares>, kNumSquares> masks = {};
+    for (auto from = 0; from < kNumSquares; ++from)
+    {
+        for (auto to = 0; to < kNumSquares; ++to)
+        {
+            masks[from][to] = BetweenMask(from, to);
+        }
+    }
+    return masks;
+}
+
+constexpr auto BetweenMasks = InitBetweenMasks();
 
-    for (auto dir = 0; dir < deltas; ++dir)
+// the eight directions a queen moves in, opposite directions are 4 apart
+constexpr const int kNumDirections = 8;
+constexpr std::array<int, kNumDirections> kDirectionRanks = {-1, -1, 0, 1, 1, 1, 0, -1};
+constexpr std::array<int, kNumDirections> kDirectionFiles = {0, 1, 1, 1, 0, -1, -1, -1};
+
+// squares from the square to the edge of the board in one direction, on an empty board
+constexpr Bitboard RayMask(int square, int direction)
+{
+    Bitboard mask = kEmptyBitboard;
+    auto r = square / kNumRanks + kDirectionRanks[direction];
+    auto f = square % kNumRanks + kDirectionFiles[direction];
+    for (; r >= 0 && r < kNumRanks && f >= 0 && f < kNumFiles; r += kDirectionRanks[direction], f += kDirectionFiles[direction])
     {
-        auto r = rank;
-        auto f = file;
+        mask |= SquareMask(r, f);
+    }
+    return mask;
+}
 
-        while (true)
+constexpr auto InitRayMasks(void)
+{
+    std::array<std::array<Bitboard, kNumSquares>, kNumDirections> masks = {};
+    for (auto direction = 0; direction < kNumDirections; ++direction)
+    {
+        for (auto sq = 0; sq < kNumSquares; ++sq)
         {
-            r += dr[dir];
-            f += df[dir];
-            if (r < 0 || r >= kNumRanks || f < 0 || f >= kNumFiles)
-            {
-                break;
-            }
+            masks[direction][sq] = RayMask(sq, direction);
+        }
+    }
+    return masks;
+}
 
-            auto sq = r * kNumRanks + f;
-            mask |= MaskFromSquare(sq);
+constexpr auto RayMasks = InitRayMasks();
 
-            if (blockers & MaskFromSquare(sq))
-            {
-                break;
-            }
+// the whole rank, file or diagonal through both squares, empty when they don't share one
+constexpr Bitboard LineMask(int from, int to)
+{
+    for (auto direction = 0; direction < kNumDirections / 2; ++direction)
+    {
+        const auto line = RayMasks[direction][from] | RayMasks[direction + kNumDirections / 2][from] | MaskFromSquare(from);
+        if (from != to && (line & MaskFromSquare(to)))
+        {
+            return line;
         }
     }
+    return kEmptyBitboard;
+}
 
-    return mask;
+constexpr auto InitLineMasks(void)
+{
+    std::array<std::array<Bitboard, kNumSquares>, kNumSquares> masks = {};
+    for (auto from = 0; from < kNumSquares; ++from)
+    {
+        for (auto to = 0; to < kNumSquares; ++to)
+        {
+            masks[from][to] = LineMask(from, to);
+        }
+    }
+    return masks;
 }
 
+constexpr auto LineMasks = InitLineMasks();
+
+static_assert(LineMasks[0][63] == 0x8040201008040201ULL && LineMasks[63][0] == LineMasks[9][54]);
+
 constexpr Bitboard KingMask(int square)
 {
     constexpr int deltas = 8;
@@ -388,4 +580,104 @@ constexpr Bitboard KingMask(int square, Bitboard attackers)
     return mask;
 }
 
-} // namespace chess
\ No newline at end of file
+// set-wise attacks of every piece in a bitboard at once, A8 is bit 0 so north is a right shift
+constexpr const Bitboard kFileA = 0x0101010101010101ULL;
+constexpr const Bitboard kFileH = 0x8080808080808080ULL;
+
+// one step in every direction, the file masks stop wrapping around the board edge
+constexpr Bitboard ShiftNorth(Bitboard b) { return b >> 8; }
+constexpr Bitboard ShiftSouth(Bitboard b) { return b << 8; }
+constexpr Bitboard ShiftEast(Bitboard b) { return (b << 1) & ~kFileA; }
+constexpr Bitboard ShiftWest(Bitboard b) { return (b >> 1) & ~kFileH; }
+constexpr Bitboard ShiftNorthEast(Bitboard b) { return (b >> 7) & ~kFileA; }
+constexpr Bitboard ShiftNorthWest(Bitboard b) { return (b >> 9) & ~kFileH; }
+constexpr Bitboard ShiftSouthEast(Bitboard b) { return (b << 9) & ~kFileA; }
+constexpr Bitboard ShiftSouthWest(Bitboard b) { return (b << 7) & ~kFileH; }
+
+constexpr Bitboard WhitePawnAttacks(Bitboard pawns)
+{
+    return ShiftNorthEast(pawns) | ShiftNorthWest(pawns);
+}
+
+constexpr Bitboard BlackPawnAttacks(Bitboard pawns)
+{
+    return ShiftSouthEast(pawns) | ShiftSouthWest(pawns);
+}
+
+constexpr Bitboard KnightAttacks(Bitboard knights)
+{
+    const auto east = ShiftEast(knights);
+    const auto west = ShiftWest(knights);
+    const auto twoEast = ShiftEast(east);
+    const auto twoWest = ShiftWest(west);
+
+    const auto one = east | west;
+    const auto two = twoEast | twoWest;
+    return (one << 16) | (one >> 16) | (two << 8) | (two >> 8);
+}
+
+constexpr Bitboard KingAttacks(Bitboard kings)
+{
+    const auto row = kings | ShiftEast(kings) | ShiftWest(kings);
+    return (row | ShiftNorth(row) | ShiftSouth(row)) & ~kings;
+}
+
+// Kogge-Stone occluded fill along one direction: the sliders flood the empty squares in
+// three doubling steps, then one more step reaches the blocker. Positive shifts move
+// towards H1, the guard drops the squares a shift wraps onto.
+template <int Shift, Bitboard Guard>
+constexpr Bitboard SlideAttacks(Bitboard sliders, Bitboard empty)
+{
+    constexpr auto shift = [](Bitboard b, int steps)
+    {
+        return Shift > 0 ? b << (Shift * steps) : b >> (-Shift * steps);
+    };
+
+    empty &= Guard;
+    sliders |= empty & shift(sliders, 1);
+    empty &= shift(empty, 1);
+    sliders |= empty & shift(sliders, 2);
+    empty &= shift(empty, 2);
+    sliders |= empty & shift(sliders, 4);
+    return shift(sliders, 1) & Guard;
+}
+
+constexpr Bitboard DiagonalAttacks(Bitboard sliders, Bitboard empty)
+{
+    return SlideAttacks<-7, ~kFileA>(sliders, empty) | SlideAttacks<-9, ~kFileH>(sliders, empty) |
+           SlideAttacks<9, ~kFileA>(sliders, empty) | SlideAttacks<7, ~kFileH>(sliders, empty);
+}
+
+constexpr Bitboard OrthogonalAttacks(Bitboard sliders, Bitboard empty)
+{
+    return SlideAttacks<-8, ~kEmptyBitboard>(sliders, empty) | SlideAttacks<8, ~kEmptyBitboard>(sliders, empty) |
+           SlideAttacks<1, ~kFileA>(sliders, empty) | SlideAttacks<-1, ~kFileH>(sliders, empty);
+}
+
+// the set-wise generators have to agree with the per-square tables
+constexpr bool CheckSetAttacks(void)
+{
+    constexpr std::array<Bitboard, 3> kBlockers = {kEmptyBitboard, 0x0042001824000100ULL, 0x00FF00000000FF00ULL};
+    for (auto sq = 0; sq < kNumSquares; ++sq)
+    {
+        const auto square = MaskFromSquare(sq);
+        if (WhitePawnAttacks(square) != WhitePawnCaptureMasks[sq] || BlackPawnAttacks(square) != BlackPawnCaptureMasks[sq] ||
+            KnightAttacks(square) != KnightMasks[sq] || KingAttacks(square) != KingMasks[sq])
+        {
+            return false;
+        }
+        for (const auto blockers : kBlockers)
+        {
+            if (DiagonalAttacks(square, ~blockers) != BishopRayMask(sq, blockers) ||
+                OrthogonalAttacks(square, ~blockers) != RookRayMask(sq, blockers))
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+static_assert(CheckSetAttacks());
+
+} // namespace chess
@@ -0,0 +1,188 @@
+#include "book.h"
+
+#include <algorithm>
+
+namespace chess
+{
+
+namespace
+{
+
+constexpr uint64_t ReadBigEndian(const uint8_t* bytes, int count)
+{
+    uint64_t value = 0;
+    for (auto i = 0; i < count; ++i)
+    {
+        value = (value << 8) | bytes[i];
+    }
+    return value;
+}
+
+// Polyglot counts ranks from a1, the board from a8
+constexpr uint8_t SquareFromBook(uint16_t bits)
+{
+    const auto file = bits & 7;
+    const auto rank = (bits >> 3) & 7;
+    return static_cast<uint8_t>((kNumRanks - 1 - rank) * kNumFiles + file);
+}
+
+constexpr uint16_t SquareToBook(uint8_t square)
+{
+    return static_cast<uint16_t>(square ^ 56);
+}
+
+// matches the raw book move against the legal moves, which also weeds out key collisions
+Move DecodeBookMove(const Chess& chess, uint16_t bits)
+{
+    const auto from = SquareFromBook(bits >> 6);
+    auto to = SquareFromBook(bits);
+    const auto promotion = (bits >> 12) & 7;
+
+    const auto piece = chess.GetPiece(from);
+    if (GetPieceType(piece) == PieceType::King && chess.GetPiece(to) == MakePiece(GetPieceColor(piece), PieceType::Rook))
+    {
+        to = (to % kNumFiles == 7) ? from + 2 : from - 2;
+    }
+
+    MoveList moves;
+    chess.MovesFromSquare(from, moves);
+    for (const auto& move : moves)
+    {
+        const auto expected = promotion == 0 ? PieceType::None : static_cast<PieceType>(promotion + 1);
+        if (move.To() == to && move.Promotion() == expected)
+        {
+            return move;
+        }
+    }
+    return kNullMove;
+}
+
+} // namespace
+
+uint16_t EncodeBookMove(Move move)
+{
+    const auto from = move.From();
+    auto to = move.To();
+    if (move.IsCastling())
+    {
+        to = (move.Flag() == MoveFlag::KingCastle) ? to + 1 : to - 2;
+    }
+
+    const auto promotion = move.IsPromotion() ? static_cast<uint16_t>(move.Promotion()) - 1 : 0;
+    return static_cast<uint16_t>(SquareToBook(to) | (SquareToBook(from) << 6) | (promotion << 12));
+}
+
+Book::Book() : data(nullptr), size(0)
+{
+}
+
+bool Book::Open(const std::string& path)
+{
+    Close();
+    if (!file.Open(path))
+    {
+        return false;
+    }
+    data = file.GetData();
+    size = file.GetSize();
+    return Validate();
+}
+
+bool Book::Load(const uint8_t* bytes, size_t count)
+{
+    Close();
+    buffer.assign(bytes, bytes + count);
+    data = buffer.data();
+    size = buffer.size();
+    return Validate();
+}
+
+void Book::Close(void)
+{
+    file.Close();
+    buffer.clear();
+    buffer.shrink_to_fit();
+    data = nullptr;
+    size = 0;
+}
+
+bool Book::Validate(void)
+{
+    if (size % kBookEntrySize != 0)
+    {
+        Close();
+        return false;
+    }
+    return true;
+}
+
+uint64_t Book::GetKey(size_t index) const
+{
+    return ReadBigEndian(data + index * kBookEntrySize, 8);
+}
+
+size_t Book::Probe(const Chess& chess, BookMove* moves, size_t capacity) const
+{
+    const auto key = chess.GetPolyglotKey();
+
+    // lower bound, the entries of one position sit next to each other
+    size_t first = 0;
+    size_t count = GetSize();
+    while (count > 0)
+    {
+        const auto half = count / 2;
+        if (GetKey(first + half) < key)
+        {
+            first += half + 1;
+            count -= half + 1;
+        }
+        else
+        {
+            count = half;
+        }
+    }
+
+    size_t found = 0;
+    for (auto i = first; i < GetSize() && GetKey(i) == key && found < capacity; ++i)
+    {
+        const auto* entry = data + i * kBookEntrySize;
+        const auto move = DecodeBookMove(chess, static_cast<uint16_t>(ReadBigEndian(entry + 8, 2)));
+        if (move != kNullMove)
+        {
+            moves[found++] = BookMove{move, static_cast<uint16_t>(ReadBigEndian(entry + 10, 2))};
+        }
+    }
+
+    std::stable_sort(moves, moves + found, [](const BookMove& a, const BookMove& b)
+                     { return a.weight > b.weight; });
+    return found;
+}
+
+Move Book::Pick(const Chess& chess, uint32_t random) const
+{
+    BookMove moves[kMaxBookMoves];
+    const auto count = Probe(chess, moves, kMaxBookMoves);
+
+    uint32_t total = 0;
+    for (size_t i = 0; i < count; ++i)
+    {
+        total += moves[i].weight;
+    }
+    if (total == 0)
+    {
+        return count > 0 ? moves[0].move : kNullMove;
+    }
+
+    auto pick = random % total;
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (pick < moves[i].weight)
+        {
+            return moves[i].move;
+        }
+        pick -= moves[i].weight;
+    }
+    return kNullMove;
+}
+
+} // namespace chess
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "chess.h"
+#include "mapped.h"
+
+namespace chess
+{
+
+// a Polyglot entry is key (8), move (2), weight (2) and learn (4) bytes, big endian, sorted by key
+constexpr const size_t kBookEntrySize = 16;
+constexpr const size_t kMaxBookMoves = 64;
+
+struct BookMove
+{
+    Move move;
+    uint16_t weight;
+};
+
+// to file, to rank, from file, from rank (3 bits each, a1 is 0) and the promotion piece,
+// castling is written as the king taking its own rook
+uint16_t EncodeBookMove(Move move);
+
+// Polyglot opening book. Files are mapped and searched in place, so a large
+// book costs a few page reads per probe and no heap.
+class Book
+{
+  public:
+    Book();
+
+    bool Open(const std::string& path);
+    // copies the bytes, for builds that can't map a file
+    bool Load(const uint8_t* data, size_t size);
+    void Close(void);
+
+    size_t GetSize(void) const { return size / kBookEntrySize; }
+
+    // the legal book moves for the position, heaviest first
+    size_t Probe(const Chess& chess, BookMove* moves, size_t capacity) const;
+
+    // a book move picked in proportion to its weight, random is any uniform value,
+    // kNullMove when the position is out of book
+    Move Pick(const Chess& chess, uint32_t random) const;
+
+  private:
+    bool Validate(void);
+    uint64_t GetKey(size_t index) const;
+
+    MappedFile file;
+    std::vector<uint8_t> buffer;
+    const uint8_t* data;
+    size_t size;
+};
+
+} // namespace chess
@@ -3,6 +3,7 @@
 #include "fen.h"
 #include "zobrist.h"
 #include <algorithm>
+#include <cassert>
 #include <sstream>
 #include <string>
 #include <vector>
@@ -10,7 +11,42 @@
 namespace chess
 {
 
-Chess::Chess()
+namespace
+{
+
+// castling rights bits run white king-side, white queen-side, black king-side, black queen-side
+constexpr int CastlingIndex(PieceColor color, bool kingSide)
+{
+    return static_cast<uint8_t>(color) * 2 + (kingSide ? 0 : 1);
+}
+
+// wherever they start, the king ends on the g or c file and the rook next to it, on the f or d file
+constexpr CastlingPath MakeCastlingPath(int index, uint8_t king, uint8_t rook)
+{
+    const auto kingSide = index % 2 == 0;
+    const auto rank = king - king % kNumFiles;
+    const auto kingTo = static_cast<uint8_t>(rank + (kingSide ? 6 : 2));
+    const auto rookTo = static_cast<uint8_t>(rank + (kingSide ? 5 : 3));
+    const auto pieces = MaskFromSquare(king) | MaskFromSquare(rook);
+
+    CastlingPath path = {};
+    path.king = king;
+    path.rook = rook;
+    path.kingTo = kingTo;
+    path.rookTo = rookTo;
+    path.xray = rook % kNumFiles != 0 && rook % kNumFiles != kNumFiles - 1;
+    path.empty = (BetweenMasks[king][kingTo] | MaskFromSquare(kingTo) | BetweenMasks[rook][rookTo] | MaskFromSquare(rookTo)) & ~pieces;
+    path.safe = BetweenMasks[king][kingTo] | MaskFromSquare(king) | MaskFromSquare(kingTo);
+    return path;
+}
+
+// the standard homes, used for any right the position doesn't hold
+constexpr std::array<uint8_t, kNumCastlings> kStandardKings = {E1, E1, E8, E8};
+constexpr std::array<uint8_t, kNumCastlings> kStandardRooks = {H1, A1, H8, A8};
+
+} // namespace
+
+Chess::Chess() : network(nullptr)
 {
     Reset();
 }
@@ -27,267 +63,337 @@ void Chess::Reset()
 
 void Chess::Clear()
 {
-    Load(KEmptyPostion);
+    // an empty board isn't a valid FEN, so skip the parser
+    FenPosition position = {};
+    position.board.fill(kNullPiece);
+    position.turn = PieceColor::White;
+    position.castlingRights = CastlingRights::None;
+    position.castlingRooks.fill(kNullSquare);
+    position.enPassant = kNullSquare;
+    position.halfmoveClock = 0;
+    position.fullmoveNumber = 1;
+    SetPosition(position);
 }
 
-void Chess::Load(const std::string& fen)
+FenError Chess::Load(std::string_view fen)
 {
-    for (auto i = 0; i < kNumSquares; i++)
+    FenPosition position;
+    const auto error = ParseFEN(fen, position);
+    if (error == FenError::None)
     {
-        board[i] = kNullPiece;
+        SetPosition(position);
     }
+    return error;
+}
 
+void Chess::SetPosition(const FenPosition& position)
+{
+    std::fill(std::begin(board), std::end(board), kNullPiece);
     for (auto c = 0; c < kNumColors; c++)
     {
-        for (auto p = 0; p < kNumColors; p++)
-        {
-            std::fill(std::begin(pieces[c]), std::end(pieces[c]), kEmptyBitboard);
-        }
+        std::fill(std::begin(pieces[c]), std::end(pieces[c]), kEmptyBitboard);
     }
 
-    undoStack.clear();
-    redoStack.clear();
+    eval.Clear();
+    if (network)
+    {
+        accumulator.Reset(*network);
+    }
 
-    loadFromFEN(fen, this);
+    for (auto sq = 0; sq < kNumSquares; ++sq)
+    {
+        PutPiece(position.board[sq], sq);
+    }
 
-    hash = ComputeZobristHash(board, turn, castlingRights, 0);
-}
+    turn = position.turn;
+    castlingRights = position.castlingRights;
 
-bool Chess::IsValidMove(int from, int to) const
-{
-    auto piece = GetPiece(from);
-    auto possible = GenerateMovesForPieceAt(piece, from);
-    return (possible & MaskFromSquare(to)) != 0;
+    // a move from or to a king or rook home takes away the rights that need it there
+    castlingRightsKept.fill(~CastlingRights::None);
+    for (auto i = 0; i < kNumCastlings; ++i)
+    {
+        const auto rook = position.castlingRooks[i];
+        const auto king = (rook == kNullSquare) ? kStandardKings[i] : MoveFromBitboard(GetKings(i < 2 ? PieceColor::White : PieceColor::Black));
+        castlingPaths[i] = MakeCastlingPath(i, king, (rook == kNullSquare) ? kStandardRooks[i] : rook);
+
+        const auto right = ~static_cast<CastlingRights>(1 << i);
+        castlingRightsKept[castlingPaths[i].king] &= right;
+        castlingRightsKept[castlingPaths[i].rook] &= right;
+    }
+    enPassantSquare = position.enPassant;
+    halfmoveClock = position.halfmoveClock;
+    fullmoveNumber = position.fullmoveNumber;
+
+    numStates = 0;
+    redoStack.clear();
+
+    hash = ComputeHash();
+    pawnHash = ComputePawnHash();
 }
 
-bool Chess::IsCastlingMove(uint8_t from, uint8_t to, Piece movingPiece) const
+const std::string Chess::GetFEN(void) const
 {
-    if (GetPieceType(movingPiece) != PieceType::King)
+    FenPosition position;
+    std::copy(std::begin(board), std::end(board), position.board.begin());
+    position.turn = turn;
+    position.castlingRights = castlingRights;
+    for (auto i = 0; i < kNumCastlings; ++i)
     {
-        return false;
+        position.castlingRooks[i] = Has(castlingRights, static_cast<CastlingRights>(1 << i)) ? castlingPaths[i].rook : kNullSquare;
     }
+    position.enPassant = enPassantSquare;
+    position.halfmoveClock = halfmoveClock;
+    position.fullmoveNumber = fullmoveNumber;
 
-    auto diff = to - from;
-    return (diff == 2 || diff == -2);
+    char fen[kMaxFenLength];
+    const auto length = WriteFEN(position, fen);
+    return std::string(fen, length);
 }
 
-bool Chess::MoveLeadsToCheck(uint8_t from, uint8_t to) const
+const MoveMasks Chess::ComputeMoveMasks(void) const
 {
-    const Bitboard fromMask = MaskFromSquare(from);
-    const Bitboard toMask = MaskFromSquare(to);
+    MoveMasks masks = {};
 
-    auto movePiece = [&](Bitboard& bb)
+    const auto us = GetTurn();
+    const auto them = GetOpponent();
+    const Bitboard theirs = GetOccupied(them);
+    const Bitboard occupancy = GetOccupied(us) | theirs;
+    const Bitboard kings = GetKings(us);
+
+    masks.checkMask = ~kEmptyBitboard;
+    masks.danger = GetAttacks(them, occupancy & ~kings);
+
+    if (kings == kEmptyBitboard)
     {
-        if (bb & fromMask)
-        {
-            bb &= ~fromMask;
-            bb |= toMask;
-            return true;
-        }
-        return false;
-    };
+        masks.king = kNullSquare;
+        return masks;
+    }
+
+    masks.king = MoveFromBitboard(kings);
+    masks.checkers = GetAttacksOnSquare(masks.king, them);
 
-    auto capturePiece = [&](Bitboard& bb)
+    switch (CountPieces(masks.checkers))
     {
-        if (bb & toMask)
-        {
-            bb &= ~toMask;
-        }
-    };
+    case 0:
+        break;
+    case 1:
+        masks.checkMask = masks.checkers | BetweenMasks[masks.king][MoveFromBitboard(masks.checkers)];
+        break;
+    default:
+        masks.checkMask = kEmptyBitboard;
+        break;
+    }
 
-    auto side = GetTurn();
-    auto opponent = GetOpponent();
+    // enemy sliders that would see the king through our own pieces
+    const Bitboard diagonals = GetBishops(them) | GetQueens(them);
+    const Bitboard orthogonals = GetRooks(them) | GetQueens(them);
+    Bitboard snipers = (BishopMask(masks.king, theirs) & diagonals) |
+                       (RookMask(masks.king, theirs) & orthogonals);
 
-    Bitboard a_pawns = GetPawns(side);
-    Bitboard a_knights = GetKnights(side);
-    Bitboard a_bishops = GetBishops(side);
-    Bitboard a_rooks = GetRooks(side);
-    Bitboard a_queens = GetQueens(side);
-    Bitboard a_kings = GetKings(side);
+    while (snipers)
+    {
+        const auto sniper = MoveFromBitboard(snipers);
+        snipers &= snipers - 1;
+
+        const Bitboard blockers = BetweenMasks[masks.king][sniper] & occupancy;
+        if (CountPieces(blockers) == 1 && (blockers & ~theirs))
+        {
+            masks.pinned |= blockers;
+        }
+    }
 
-    Bitboard b_pawns = GetPawns(opponent);
-    Bitboard b_knights = GetKnights(opponent);
-    Bitboard b_bishops = GetBishops(opponent);
-    Bitboard b_rooks = GetRooks(opponent);
-    Bitboard b_queens = GetQueens(opponent);
-    Bitboard b_kings = GetKings(opponent);
+    return masks;
+}
 
-    capturePiece(b_pawns);
-    capturePiece(b_knights);
-    capturePiece(b_bishops);
-    capturePiece(b_rooks);
-    capturePiece(b_queens);
-    capturePiece(b_kings);
+bool Chess::IsLegalEnPassant(uint8_t from, const MoveMasks& masks) const
+{
+    const auto them = GetOpponent();
+    const auto captured = (GetTurn() == PieceColor::White) ? enPassantSquare + kNumRanks : enPassantSquare - kNumRanks;
+    const Bitboard capturedMask = MaskFromSquare(captured);
+    const Bitboard toMask = MaskFromSquare(enPassantSquare);
 
-    // short circuit if we found a move
-    movePiece(a_pawns) || movePiece(a_knights) || movePiece(a_bishops) ||
-        movePiece(a_rooks) || movePiece(a_queens) || movePiece(a_kings);
+    if (((capturedMask | toMask) & masks.checkMask) == kEmptyBitboard)
+    {
+        return false;
+    }
 
-    Bitboard occ = a_pawns | a_knights | a_bishops | a_rooks | a_queens | a_kings |
-                   b_pawns | b_knights | b_bishops | b_rooks | b_queens | b_kings;
+    if (masks.king == kNullSquare)
+    {
+        return true;
+    }
 
-    auto a_king = MoveFromBitboard(a_kings);
+    // both pawns leave the rank at once, so replay the capture against the sliders
+    const Bitboard occupancy = ((GetOccupied(PieceColor::White) | GetOccupied(PieceColor::Black)) &
+                                ~(MaskFromSquare(from) | capturedMask)) |
+                               toMask;
 
-    Bitboard attackers = 0ULL;
-    attackers |= (opponent == PieceColor::White)
-                     ? (WhitePawnCaptureMasks[a_king] & b_pawns)
-                     : (BlackPawnCaptureMasks[a_king] & b_pawns);
-    attackers |= KnightMasks[a_king] & b_knights;
-    attackers |= KingMasks[a_king] & b_kings;
-    attackers |= BishopMask(a_king, occ) & (b_bishops | b_queens);
-    attackers |= RookMask(a_king, occ) & (b_rooks | b_queens);
+    const Bitboard diagonals = GetBishops(them) | GetQueens(them);
+    const Bitboard orthogonals = GetRooks(them) | GetQueens(them);
 
-    return attackers != 0ULL;
+    return ((BishopMask(masks.king, occupancy) & diagonals) |
+            (RookMask(masks.king, occupancy) & orthogonals)) == kEmptyBitboard;
 }
 
-bool Chess::MovePiece(uint8_t from, uint8_t to)
+bool Chess::MovePiece(uint8_t from, uint8_t to, PieceType promotion)
 {
-    if ((from == to) || (from < 0 || from >= kNumSquares || to < 0 || to >= kNumSquares))
+    if ((from == to) || (from >= kNumSquares || to >= kNumSquares) || (numStates >= kMaxGamePly))
     {
         return false;
     }
 
-    auto moving = board[from];
-    auto captured = board[to];
+    MoveList moves;
+    MovesFromSquare(from, moves);
+    for (const auto& move : moves)
+    {
+        // the king can also castle by being dropped on its own rook, the usual Chess960 gesture
+        const auto rook = move.IsCastling() ? castlingPaths[CastlingIndex(GetTurn(), move.Flag() == MoveFlag::KingCastle)].rook : kNullSquare;
+        if ((move.To() == to || rook == to) && (!move.IsPromotion() || move.Promotion() == promotion))
+        {
+            redoStack.clear();
+            MakeMove(move);
+            return true;
+        }
+    }
+    return false;
+}
 
-    if (GetPieceColor(moving) != GetTurn())
+bool Chess::MovePiece(Move move)
+{
+    if (numStates >= kMaxGamePly)
     {
         return false;
     }
 
-    if (!IsValidMove(from, to))
+    MoveList moves;
+    MovesFromSquare(move.From(), moves);
+    for (const auto& legal : moves)
     {
-        return false;
+        if (legal == move)
+        {
+            redoStack.clear();
+            MakeMove(move);
+            return true;
+        }
     }
+    return false;
+}
 
+void Chess::MakeMove(Move move)
+{
+    const auto from = move.From();
+    const auto to = move.To();
+    const auto moving = board[from];
     const auto type = GetPieceType(moving);
     const auto color = GetPieceColor(moving);
 
-    auto isEnPassant = (type == PieceType::Pawn && to == enPassantSquare && GetPieceType(captured) == PieceType::None);
-    auto enPassantCaptureSquare = kNullSquare;
-    if (isEnPassant)
-    {
-        enPassantCaptureSquare = (color == PieceColor::White) ? to + kNumRanks : to - kNumRanks;
-        captured = board[enPassantCaptureSquare];
-        RemovePiece(enPassantCaptureSquare);
-    }
+    const auto capturedSquare = move.IsEnPassant()
+                                    ? ((color == PieceColor::White) ? to + kNumRanks : to - kNumRanks)
+                                    : to;
+    const auto captured = move.IsCapture() ? board[capturedSquare] : kNullPiece;
+    const auto prevCastlingRights = castlingRights;
 
-    // Move the king
-    RemovePiece(to);
-    RemovePiece(from);
-    PutPiece(moving, to);
+    hashHistory[numStates] = hash;
+    states[numStates++] = chess::Undo{
+        .move = move,
+        .captured = captured,
+        .enPassant = enPassantSquare,
+        .castlingRights = castlingRights,
+        .halfmoveClock = halfmoveClock,
+    };
 
-    if (IsCastlingMove(from, to, moving))
+    // the fifty move counter starts over on every pawn move and capture
+    halfmoveClock = (type == PieceType::Pawn || captured != kNullPiece) ? 0 : halfmoveClock + 1;
+    if (color == PieceColor::Black)
     {
-        if (turn == PieceColor::White)
-        {
-            auto piece = MakePiece(PieceColor::White, PieceType::Rook);
-            if (to % 8 == 6) // king-side castle (king moves to G1 = 6)
-            {
-                RemovePiece(H1);
-                PutPiece(piece, F1);
-            }
-            else if (to % 8 == 2) // queen-side castle (king moves to C1 = 2)
-            {
-                RemovePiece(A1);
-                PutPiece(piece, D1);
-            }
-        }
-        else if (turn == PieceColor::Black)
-        {
-            auto piece = MakePiece(PieceColor::Black, PieceType::Rook);
-            if (to % 8 == 6) // king-side castle (king moves to G8 = 62 % 8 = 6)
-            {
-                RemovePiece(H8);
-                PutPiece(piece, F8);
-            }
-            else if (to % 8 == 2) // queen-side castle (king moves to C8 = 58 % 8 = 2)
-            {
-                RemovePiece(A8);
-                PutPiece(piece, D8);
-            }
-        }
+        ++fullmoveNumber;
     }
 
-    // castling rights
-    const auto prevCastlingRights = castlingRights;
-    switch (type)
-    {
-    case PieceType::Rook:
+    if (move.IsCastling())
     {
-        switch (color)
-        {
-        case PieceColor::White:
-            if (from == H1)
-            {
-                castlingRights &= ~CastlingRights::WhiteKingSide;
-            }
-            else if (from == A1)
-            {
-                castlingRights &= ~CastlingRights::WhiteQueenSide;
-            }
-            break;
-        case PieceColor::Black:
-            if (from == H8)
-            {
-                castlingRights &= ~CastlingRights::BlackKingSide;
-            }
-            else if (from == A8)
-            {
-                castlingRights &= ~CastlingRights::BlackQueenSide;
-            }
-            break;
-        }
-        break;
+        MoveCastlingPieces(move, false);
     }
-    case PieceType::King:
+    else
     {
-        switch (color)
-        {
-        case PieceColor::White:
-            castlingRights &= ~(CastlingRights::WhiteKingSide | CastlingRights::WhiteQueenSide);
-            break;
-        case PieceColor::Black:
-            castlingRights &= ~(CastlingRights::BlackKingSide | CastlingRights::BlackQueenSide);
-            break;
-        }
-        break;
-    }
-    default:
-        break;
+        RemovePiece(capturedSquare);
+
+        RemovePiece(from);
+        PutPiece(move.IsPromotion() ? MakePiece(color, move.Promotion()) : moving, to);
     }
 
+    // moving a king or rook from home, or capturing a rook there, takes away the rights that need it
+    castlingRights &= castlingRightsKept[from] & castlingRightsKept[to];
+
     // enpassent
-    auto prevEnPassant = enPassantSquare;
-    enPassantSquare = kNullSquare;
-    if (type == PieceType::Pawn)
+    if (enPassantSquare != kNullSquare)
     {
-        if (abs((int)to - (int)from) == 16)
-        {
-            enPassantSquare = (from + to) / 2;
-            enPassantCaptureSquare = (turn == PieceColor::White)
-                                         ? enPassantSquare + kNumFiles
-                                         : enPassantSquare - kNumFiles;
-        }
+        hash ^= zobrist.enpassant[enPassantSquare % kNumFiles];
+    }
+    enPassantSquare = move.IsDoublePawnPush() ? (from + to) / 2 : kNullSquare;
+    if (enPassantSquare != kNullSquare)
+    {
+        hash ^= zobrist.enpassant[enPassantSquare % kNumFiles];
     }
 
+    // pieces are hashed in PutPiece/RemovePiece
+    hash ^= zobrist.castling[static_cast<uint8_t>(prevCastlingRights)];
+    hash ^= zobrist.castling[static_cast<uint8_t>(castlingRights)];
+    hash ^= zobrist.side;
+
     turn = GetOpponent();
 
-    // cache move
-    redoStack.clear();
-    undoStack.push_back(chess::Undo{
-        .move = {moving, from, to},
-        .captured = captured,
-        .enPassantCaptureSquare = enPassantCaptureSquare,
-        .oldEnPassant = prevEnPassant,
-        .newEnPassant = enPassantSquare,
-        .oldCastlingRights = prevCastlingRights,
-        .newCastlingRights = castlingRights,
-    });
+    assert(hash == ComputeHash());
+    assert(pawnHash == ComputePawnHash());
+}
 
-    UpdateZobristMove(moving, from, to, captured, 0x00, castlingRights, prevCastlingRights);
+void Chess::MoveCastlingPieces(Move move, bool undo)
+{
+    const auto& path = castlingPaths[CastlingIndex(turn, move.Flag() == MoveFlag::KingCastle)];
+    const auto kingFrom = undo ? path.kingTo : path.king;
+    const auto kingTo = undo ? path.king : path.kingTo;
+    const auto rookFrom = undo ? path.rookTo : path.rook;
+    const auto rookTo = undo ? path.rook : path.rookTo;
+
+    // in Chess960 either piece may land where the other started, so both leave first
+    const auto king = GetPiece(kingFrom);
+    const auto rook = GetPiece(rookFrom);
+    RemovePiece(kingFrom);
+    RemovePiece(rookFrom);
+    PutPiece(king, kingTo);
+    PutPiece(rook, rookTo);
+}
 
-    return true;
+void Chess::SetTurn(const PieceColor color)
+{
+    if (color != turn)
+    {
+        hash ^= zobrist.side;
+        turn = color;
+    }
+}
+
+void Chess::SetCastlingRights(CastlingRights rights)
+{
+    hash ^= zobrist.castling[static_cast<uint8_t>(castlingRights)];
+    castlingRights |= rights;
+    hash ^= zobrist.castling[static_cast<uint8_t>(castlingRights)];
+}
+
+void Chess::SetNetwork(const Network* network)
+{
+    this->network = network;
+    if (network == nullptr)
+    {
+        return;
+    }
+
+    accumulator.Reset(*network);
+    for (auto sq = 0; sq < kNumSquares; ++sq)
+    {
+        if (GetPieceType(board[sq]) != PieceType::None)
+        {
+            accumulator.Add(*network, board[sq], sq);
+        }
+    }
 }
 
 Piece Chess::GetPiece(uint8_t square) const
@@ -302,7 +408,22 @@ void Chess::PutPiece(Piece piece, uint8_t square)
         return;
     }
 
+    if (GetPieceType(board[square]) != PieceType::None)
+    {
+        RemovePiece(square);
+    }
+
     board[square] = piece;
+    hash ^= zobrist.psq[GetPieceIndex(piece)][square];
+    eval.Add(piece, square);
+    if (network)
+    {
+        accumulator.Add(*network, piece, square);
+    }
+    if (GetPieceType(piece) == PieceType::Pawn)
+    {
+        pawnHash ^= zobrist.psq[GetPieceIndex(piece)][square];
+    }
 
     auto type = static_cast<uint8_t>(GetPieceType(piece));
     auto color = static_cast<uint8_t>(GetPieceColor(piece));
@@ -318,51 +439,79 @@ void Chess::RemovePiece(uint8_t square)
     }
 
     board[square] = kNullPiece;
+    hash ^= zobrist.psq[GetPieceIndex(piece)][square];
+    eval.Remove(piece, square);
+    if (network)
+    {
+        accumulator.Remove(*network, piece, square);
+    }
+    if (GetPieceType(piece) == PieceType::Pawn)
+    {
+        pawnHash ^= zobrist.psq[GetPieceIndex(piece)][square];
+    }
 
     auto type = static_cast<uint8_t>(GetPieceType(piece));
     auto color = static_cast<uint8_t>(GetPieceColor(piece));
     pieces[color][type] &= ~MaskFromSquare(square);
 }
 
-void Chess::Undo(void)
+void Chess::UnmakeMove(void)
 {
-    if (undoStack.empty())
-    {
-        return;
-    }
+    const auto& prev = states[--numStates];
 
-    auto prev = undoStack.back();
-    undoStack.pop_back();
+    const auto from = prev.move.From();
+    const auto to = prev.move.To();
 
-    RemovePiece(prev.move.to);
-
-    auto isEnPassant = (GetPieceType(prev.move.piece) == PieceType::Pawn &&
-                        prev.move.to == prev.oldEnPassant);
+    turn = GetOpponent();
 
-    if (isEnPassant)
+    if (prev.move.IsCastling())
     {
-        PutPiece(prev.captured, prev.enPassantCaptureSquare);
+        MoveCastlingPieces(prev.move, true);
     }
-    else if (GetPieceType(prev.captured) != PieceType::None)
+    else
     {
-        PutPiece(prev.captured, prev.move.to);
+        const auto moved = board[to];
+        RemovePiece(to);
+        PutPiece(prev.move.IsPromotion() ? MakePiece(turn, PieceType::Pawn) : moved, from);
     }
 
-    PutPiece(prev.move.piece, prev.move.from);
+    if (prev.move.IsEnPassant())
+    {
+        PutPiece(prev.captured, (turn == PieceColor::White) ? to + kNumRanks : to - kNumRanks);
+    }
+    else if (prev.move.IsCapture())
+    {
+        PutPiece(prev.captured, to);
+    }
 
     // game state
-    enPassantSquare = prev.oldEnPassant;
-    castlingRights = prev.oldCastlingRights;
-    turn = GetOpponent();
+    enPassantSquare = prev.enPassant;
+    castlingRights = prev.castlingRights;
+    halfmoveClock = prev.halfmoveClock;
+    hash = hashHistory[numStates];
+    if (turn == PieceColor::Black)
+    {
+        --fullmoveNumber;
+    }
 
-    UpdateZobristMove(prev.move.piece, prev.move.from, prev.move.to, prev.captured, prev.newEnPassant, prev.newCastlingRights, prev.oldCastlingRights);
+    assert(hash == ComputeHash());
+    assert(pawnHash == ComputePawnHash());
+}
+
+void Chess::Undo(void)
+{
+    if (numStates == 0)
+    {
+        return;
+    }
 
-    redoStack.push_back(prev);
+    redoStack.push_back(states[numStates - 1].move);
+    UnmakeMove();
 }
 
 void Chess::Redo(void)
 {
-    if (redoStack.empty())
+    if (redoStack.empty() || numStates >= kMaxGamePly)
     {
         return;
     }
@@ -370,23 +519,7 @@ void Chess::Redo(void)
     auto next = redoStack.back();
     redoStack.pop_back();
 
-    auto isEnPassant = (GetPieceType(next.move.piece) == PieceType::Pawn &&
-                        next.move.to == next.oldEnPassant);
-
-    // move pieces
-    RemovePiece(next.move.from);
-    RemovePiece(isEnPassant ? next.enPassantCaptureSquare : next.move.to);
-    PutPiece(next.move.piece, next.move.to);
-
-    // game state
-    enPassantSquare = next.newEnPassant;
-    castlingRights = next.newCastlingRights;
-    turn = GetOpponent();
-
-    // update the hash
-    UpdateZobristMove(next.move.piece, next.move.from, next.move.to, next.captured, 0x00, next.oldCastlingRights, next.newCastlingRights);
-
-    undoStack.push_back(next);
+    MakeMove(next);
 }
 
 const std::vector<Piece> Chess::GetBoard() const
@@ -406,62 +539,44 @@ const Bitboard Chess::GetOccupied(const PieceColor color) const
     const auto pawns = GetPawns(color);
     const auto knights = GetKnights(color);
     const auto bishops = GetBishops(color);
+    const auto rooks = GetRooks(color);
     const auto queens = GetQueens(color);
     const auto kings = GetKings(color);
-    return pawns | knights | bishops | queens | kings;
+    return pawns | knights | bishops | rooks | queens | kings;
 }
 
 const Bitboard Chess::GetAttacks(PieceColor from) const
 {
-    Bitboard attacks = kEmptyBitboard;
-    const Bitboard occupancy = GetOccupied(PieceColor::White) | GetOccupied(PieceColor::Black);
-
-    for (auto i = 0; i < kNumSquares; ++i)
-    {
-        auto piece = GetPiece(i);
-        if ((GetPieceType(piece) == PieceType::None) || (GetPieceColor(piece) != from))
-        {
-            continue;
-        }
+    return GetAttacks(from, GetOccupied(PieceColor::White) | GetOccupied(PieceColor::Black));
+}
 
-        switch (GetPieceType(piece))
-        {
-        case PieceType::Pawn:
-            attacks |= (from == PieceColor::White)
-                           ? WhitePawnCaptureMasks[i]
-                           : BlackPawnCaptureMasks[i];
-            break;
-        case PieceType::Knight:
-            attacks |= KnightMasks[i];
-            break;
-        case PieceType::Bishop:
-            attacks |= BishopMask(i, occupancy);
-            break;
-        case PieceType::Rook:
-            attacks |= RookMask(i, occupancy);
-            break;
-        case PieceType::Queen:
-            attacks |= QueenMask(i, occupancy);
-            break;
-        case PieceType::King:
-            attacks |= KingMasks[i];
-            break;
-        default:
-            break;
-        }
-    }
+const Bitboard Chess::GetAttacks(PieceColor from, const Bitboard occupancy) const
+{
+    // every piece type at once, so the cost doesn't depend on how many pieces there are
+    const auto empty = ~occupancy;
+    const auto queens = GetQueens(from);
+
+    Bitboard attacks = (from == PieceColor::White) ? WhitePawnAttacks(GetPawns(from)) : BlackPawnAttacks(GetPawns(from));
+    attacks |= KnightAttacks(GetKnights(from));
+    attacks |= KingAttacks(GetKings(from));
+    attacks |= DiagonalAttacks(GetBishops(from) | queens, empty);
+    attacks |= OrthogonalAttacks(GetRooks(from) | queens, empty);
     return attacks;
 }
 
 const Bitboard Chess::GetAttacksOnSquare(uint8_t square, PieceColor from) const
 {
-    Bitboard attackers = kEmptyBitboard;
+    return GetAttacksOnSquare(square, from, GetOccupied(PieceColor::White) | GetOccupied(PieceColor::Black));
+}
 
-    const Bitboard occupancy = GetOccupied(PieceColor::White) | GetOccupied(PieceColor::Black);
+const Bitboard Chess::GetAttacksOnSquare(uint8_t square, PieceColor from, const Bitboard occupancy) const
+{
+    Bitboard attackers = kEmptyBitboard;
 
+    // a white pawn attacks the square from where a black pawn on it would capture, and vice versa
     attackers |= (from == PieceColor::White)
-                     ? (WhitePawnCaptureMasks[square] & GetPawns(from))
-                     : (BlackPawnCaptureMasks[square] & GetPawns(from));
+                     ? (BlackPawnCaptureMasks[square] & GetPawns(from))
+                     : (WhitePawnCaptureMasks[square] & GetPawns(from));
     attackers |= KnightMasks[square] & GetKnights(from);
     attackers |= KingMasks[square] & GetKings(from);
     attackers |= BishopMask(square, occupancy) & (GetBishops(from) | GetQueens(from));
@@ -472,6 +587,11 @@ const Bitboard Chess::GetAttacksOnSquare(uint8_t square, PieceColor from) const
 
 bool Chess::InCheck(PieceColor turn) const
 {
+    if (GetKings(turn) == kEmptyBitboard)
+    {
+        return false;
+    }
+
     const auto king = MoveFromBitboard(GetKings(turn));
     const auto attacking = CountPieces(GetAttacksOnSquare(king, GetOpposite(turn)));
     return attacking >= 1;
@@ -485,104 +605,270 @@ bool Chess::InCheckmate(void) const
         return false;
     }
 
+    const auto masks = ComputeMoveMasks();
+
     Bitboard legalMoves = kEmptyBitboard;
-    for (auto i = 0; i < kNumSquares; i++)
+    Bitboard pieces = GetOccupied(turn);
+    while (pieces && legalMoves == kEmptyBitboard)
     {
-        auto piece = GetPiece(i);
-        if (GetPieceColor(piece) != turn)
-        {
-            continue;
-        }
+        auto from = MoveFromBitboard(pieces);
+        pieces &= pieces - 1;
 
-        legalMoves |= GenerateMovesForPieceAt(piece, i);
+        legalMoves |= GenerateLegalMoves(from, masks);
     }
 
     return legalMoves == kEmptyBitboard;
 }
 
-const std::vector<chess::Move> Chess::Moves(void) const
+bool Chess::IsDraw(int repetitions) const
 {
-    std::vector<chess::Move> moves = {};
-    for (auto from = 0; from < kNumSquares; from++)
+    // a mate delivered on the hundredth ply still wins
+    if (halfmoveClock >= 100 && !InCheckmate())
+    {
+        return true;
+    }
+
+    // only positions since the last pawn move or capture can come back, with the same side
+    // to move, and the earliest one is four plies ago
+    const auto reversible = std::min<int>(halfmoveClock, numStates);
+    auto seen = 0;
+    for (auto ply = 4; ply <= reversible; ply += 2)
     {
-        auto piece = GetPiece(from);
-        auto color = GetPieceColor(piece);
-        if (GetPieceType(piece) == PieceType::None || color != GetTurn())
+        if (hashHistory[numStates - ply] == hash && ++seen >= repetitions)
         {
-            continue;
+            return true;
         }
+    }
+    return false;
+}
 
-        auto possibleMoves = GenerateMovesForPieceAt(piece, from);
-        while (possibleMoves)
-        {
-            auto to = MoveFromBitboard(possibleMoves);
-            possibleMoves &= possibleMoves - 1;
+void Chess::Moves(MoveList& moves, MoveGen gen) const
+{
+    moves.clear();
+    const auto masks = ComputeMoveMasks();
+
+    const Bitboard enemy = GetOccupied(GetOpponent());
+    const Bitboard pawns = GetPawns(GetTurn());
+    const Bitboard enPassant = (enPassantSquare != kNullSquare) ? MaskFromSquare(enPassantSquare) : kEmptyBitboard;
 
-            moves.push_back((chess::Move){
-                .from = (uint8_t)from,
-                .to = to,
-            });
+    Bitboard pieces = GetOccupied(GetTurn());
+    while (pieces)
+    {
+        auto from = MoveFromBitboard(pieces);
+        pieces &= pieces - 1;
+
+        auto targets = GenerateLegalMoves(from, masks);
+        if (gen != MoveGen::All)
+        {
+            auto noisy = enemy;
+            if (pawns & MaskFromSquare(from))
+            {
+                noisy |= enPassant | kBackRanks;
+            }
+            targets &= (gen == MoveGen::Captures) ? noisy : ~noisy;
         }
+
+        AddMoves(moves, from, targets);
+    }
+
+    if (gen != MoveGen::Captures)
+    {
+        AddCastlingMoves(moves, masks);
     }
-    return moves;
 }
 
-const std::vector<chess::Move> Chess::MovesFromSquare(uint8_t from) const
+void Chess::MovesFromSquare(uint8_t from, MoveList& moves) const
 {
-    std::vector<chess::Move> moves = {};
+    moves.clear();
     auto piece = GetPiece(from);
     auto color = GetPieceColor(piece);
     if (GetPieceType(piece) == PieceType::None || color != GetTurn())
     {
-        return moves;
+        return;
     }
 
-    auto possibleMoves = GenerateMovesForPieceAt(piece, from);
-    while (possibleMoves)
+    const auto masks = ComputeMoveMasks();
+    AddMoves(moves, from, GenerateLegalMoves(from, masks));
+    if (GetPieceType(piece) == PieceType::King)
     {
-        auto to = MoveFromBitboard(possibleMoves);
-        possibleMoves &= possibleMoves - 1;
+        AddCastlingMoves(moves, masks);
+    }
+}
 
-        moves.push_back((chess::Move){
-            .from = (uint8_t)from,
-            .to = to,
-        });
+void Chess::MovesForPiece(Piece piece, MoveList& moves) const
+{
+    moves.clear();
+    const auto type = GetPieceType(piece);
+    const auto color = GetPieceColor(piece);
+    if (type == PieceType::None || color != GetTurn())
+    {
+        return;
     }
 
-    return moves;
+    const auto masks = ComputeMoveMasks();
+
+    Bitboard pieces = this->pieces[static_cast<uint8_t>(color)][static_cast<uint8_t>(type)];
+    while (pieces)
+    {
+        auto from = MoveFromBitboard(pieces);
+        pieces &= pieces - 1;
+
+        AddMoves(moves, from, GenerateLegalMoves(from, masks));
+    }
+
+    if (type == PieceType::King)
+    {
+        AddCastlingMoves(moves, masks);
+    }
 }
 
-const std::vector<chess::Move> Chess::MovesForPiece(Piece piece) const
+bool Chess::IsLegal(Move move) const
 {
-    std::vector<chess::Move> moves = {};
-    const auto type = GetPieceColor(piece);
-    const auto color = GetPieceColor(piece);
+    MoveList moves;
+    MovesFromSquare(move.From(), moves);
+    return std::find(moves.begin(), moves.end(), move) != moves.end();
+}
 
-    for (auto from = 0; from < kNumSquares; from++)
+int Chess::See(Move move) const
+{
+    if (move.IsCastling())
     {
-        if (piece != GetPiece(from))
+        return 0;
+    }
+
+    const auto from = move.From();
+    const auto to = move.To();
+
+    // gain[i] is the balance for the side making capture i if the sequence stops there
+    std::array<int, 32> gain = {};
+    auto depth = 0;
+
+    auto onSquare = GetPieceType(GetPiece(from));
+    gain[0] = kPieceValues[static_cast<uint8_t>(move.IsEnPassant() ? PieceType::Pawn : GetPieceType(GetPiece(to)))];
+    if (move.IsPromotion())
+    {
+        onSquare = move.Promotion();
+        gain[0] += kPieceValues[static_cast<uint8_t>(onSquare)] - kPieceValues[static_cast<uint8_t>(PieceType::Pawn)];
+    }
+
+    Bitboard occupancy = (GetOccupied(PieceColor::White) | GetOccupied(PieceColor::Black)) & ~MaskFromSquare(from);
+    if (move.IsEnPassant())
+    {
+        occupancy &= ~MaskFromSquare(GetTurn() == PieceColor::White ? to + kNumFiles : to - kNumFiles);
+    }
+
+    auto side = GetOpponent();
+    while (depth + 1 < static_cast<int>(gain.size()))
+    {
+        // attackers are recomputed from the shrinking occupancy, so sliders behind a capturer join in
+        const Bitboard attackers = GetAttacksOnSquare(to, side, occupancy) & occupancy;
+        if (attackers == kEmptyBitboard)
         {
-            continue;
+            break;
         }
-        auto color = GetPieceColor(piece);
-        if (GetPieceType(piece) == PieceType::None || color != GetTurn())
+
+        // the least valuable attacker recaptures
+        auto type = PieceType::Pawn;
+        Bitboard candidates = kEmptyBitboard;
+        for (auto t = static_cast<uint8_t>(PieceType::Pawn); t <= static_cast<uint8_t>(PieceType::King); ++t)
         {
-            continue;
+            candidates = attackers & pieces[static_cast<uint8_t>(side)][t];
+            if (candidates)
+            {
+                type = static_cast<PieceType>(t);
+                break;
+            }
         }
+        const Bitboard capturer = candidates & (~candidates + 1);
 
-        auto possibleMoves = GenerateMovesForPieceAt(piece, from);
-        while (possibleMoves)
+        // the king may only take an undefended piece
+        if (type == PieceType::King &&
+            (GetAttacksOnSquare(to, GetOpposite(side), occupancy & ~capturer) & (occupancy & ~capturer)))
         {
-            auto to = MoveFromBitboard(possibleMoves);
-            possibleMoves &= possibleMoves - 1;
+            break;
+        }
 
-            moves.push_back((chess::Move){
-                .from = (uint8_t)from,
-                .to = to,
-            });
+        // whatever follows, this capture can only score balance or less, so stop when standing pat is as good
+        const auto balance = kPieceValues[static_cast<uint8_t>(onSquare)] - gain[depth];
+        if (balance <= -gain[depth])
+        {
+            break;
+        }
+        gain[++depth] = balance;
+
+        occupancy &= ~capturer;
+        onSquare = type;
+        side = GetOpposite(side);
+    }
+
+    // either side may stop capturing when it would only lose more
+    for (; depth > 0; --depth)
+    {
+        gain[depth - 1] = -std::max(-gain[depth - 1], gain[depth]);
+    }
+    return gain[0];
+}
+
+void Chess::AddMoves(MoveList& moves, uint8_t from, Bitboard targets) const
+{
+    const auto type = GetPieceType(GetPiece(from));
+
+    while (targets)
+    {
+        const auto to = MoveFromBitboard(targets);
+        targets &= targets - 1;
+
+        const auto capture = GetPieceType(GetPiece(to)) != PieceType::None;
+
+        switch (type)
+        {
+        case PieceType::Pawn:
+            if (MaskFromSquare(to) & kBackRanks)
+            {
+                moves.push_back(Move(from, to, MakePromotionFlag(PieceType::Queen, capture)));
+                moves.push_back(Move(from, to, MakePromotionFlag(PieceType::Rook, capture)));
+                moves.push_back(Move(from, to, MakePromotionFlag(PieceType::Bishop, capture)));
+                moves.push_back(Move(from, to, MakePromotionFlag(PieceType::Knight, capture)));
+            }
+            else if (to == enPassantSquare)
+            {
+                moves.push_back(Move(from, to, MoveFlag::EnPassant));
+            }
+            else if (to - from == 2 * kNumFiles || from - to == 2 * kNumFiles)
+            {
+                moves.push_back(Move(from, to, MoveFlag::DoublePawnPush));
+            }
+            else
+            {
+                moves.push_back(Move(from, to, capture ? MoveFlag::Capture : MoveFlag::Quiet));
+            }
+            break;
+        default:
+            moves.push_back(Move(from, to, capture ? MoveFlag::Capture : MoveFlag::Quiet));
+            break;
+        }
+    }
+}
+
+void Chess::AddCastlingMoves(MoveList& moves, const MoveMasks& masks) const
+{
+    const Bitboard occupied = GetOccupied(PieceColor::White) | GetOccupied(PieceColor::Black);
+    const Bitboard orthogonals = GetRooks(GetOpponent()) | GetQueens(GetOpponent());
+
+    for (const auto kingSide : {true, false})
+    {
+        const auto index = CastlingIndex(GetTurn(), kingSide);
+        const auto& path = castlingPaths[index];
+
+        // the way is clear, the king doesn't start, cross or land in check, and when the rook
+        // isn't in the corner, it wasn't the only thing keeping a slider off the king's target
+        if (Has(castlingRights, static_cast<CastlingRights>(1 << index)) &&
+            !(occupied & path.empty) && !(masks.danger & path.safe) &&
+            (!path.xray || !(RookMask(path.kingTo, occupied & ~MaskFromSquare(path.rook)) & orthogonals)))
+        {
+            moves.push_back(Move(path.king, path.kingTo, kingSide ? MoveFlag::KingCastle : MoveFlag::QueenCastle));
         }
     }
-    return moves;
 }
 
 const Bitboard Chess::GeneratePawnMoves(uint8_t square) const
@@ -653,133 +939,91 @@ const Bitboard Chess::GenerateQueenMoves(uint8_t square, const Bitboard blockers
     return QueenMask(square, blockers);
 }
 
-const Bitboard Chess::GenerateKingMoves(uint8_t square) const
+// castling comes from AddCastlingMoves, in Chess960 it can land where a plain king move does
+const Bitboard Chess::GenerateKingMoves(uint8_t square, const Bitboard danger) const
 {
-    Bitboard possibleMoves = KingMasks[square];
-    possibleMoves &= ~GetAttacks(GetOpponent());
+    return KingMasks[square] & ~danger;
+}
 
-    const Bitboard occupied = GetOccupied(PieceColor::White) | GetOccupied(PieceColor::Black);
+const Bitboard Chess::GenerateLegalMoves(uint8_t square, const MoveMasks& masks) const
+{
+    const auto type = GetPieceType(GetPiece(square));
+    const Bitboard friendly = GetOccupied(GetTurn());
 
-    auto isSafe = [&](uint8_t sq) -> bool
+    if (type == PieceType::King)
     {
-        return (GetAttacksOnSquare(sq, GetOpponent()) == 0);
-    };
+        return GenerateKingMoves(square, masks.danger) & ~friendly;
+    }
 
-    switch (GetTurn())
+    // only the king can answer a double check
+    if (masks.checkMask == kEmptyBitboard)
     {
-    case PieceColor::White:
-        if (Has(castlingRights, CastlingRights::WhiteKingSide) &&
-            !(occupied & (MaskFromSquare(F1) | MaskFromSquare(G1))) && // no pieces in between
-            isSafe(E1) && isSafe(F1) && isSafe(G1))                    // can't pass through check
-        {
-            possibleMoves |= MaskFromSquare(G1);
-        }
-        if (Has(castlingRights, CastlingRights::WhiteQueenSide) &&
-            !(occupied & (MaskFromSquare(D1) | MaskFromSquare(C1) | MaskFromSquare(B1))) && // no pieces in between
-            isSafe(E1) && isSafe(D1) && isSafe(C1))
-        {
-            possibleMoves |= MaskFromSquare(C1);
-        }
-        break;
-
-    case PieceColor::Black:
-        if (Has(castlingRights, CastlingRights::BlackKingSide) &&
-            !(occupied & (MaskFromSquare(F8) | MaskFromSquare(G8))) &&
-            isSafe(E8) && isSafe(F8) && isSafe(G8))
-        {
-            possibleMoves |= MaskFromSquare(G8);
-        }
-        if (Has(castlingRights, CastlingRights::BlackQueenSide) &&
-            !(occupied & (MaskFromSquare(D8) | MaskFromSquare(C8) | MaskFromSquare(B8))) &&
-            isSafe(E8) && isSafe(D8) && isSafe(C8))
-        {
-            possibleMoves |= MaskFromSquare(C8);
-        }
-        break;
+        return kEmptyBitboard;
     }
 
-    return possibleMoves;
-}
+    const Bitboard blockers = friendly | GetOccupied(GetOpponent());
 
-const Bitboard Chess::GenerateMovesForPieceAt(const Piece piece, uint8_t square) const
-{
     Bitboard possibleMoves = kEmptyBitboard;
+    switch (type)
+    {
+    case PieceType::Pawn:
+        possibleMoves = GeneratePawnMoves(square);
+        break;
+    case PieceType::Knight:
+        possibleMoves = GenerateKnightMoves(square);
+        break;
+    case PieceType::Bishop:
+        possibleMoves = GenerateBishopMoves(square, blockers);
+        break;
+    case PieceType::Rook:
+        possibleMoves = GenerateRookMoves(square, blockers);
+        break;
+    case PieceType::Queen:
+        possibleMoves = GenerateQueenMoves(square, blockers);
+        break;
+    default:
+        break;
+    }
 
-    const auto type = GetPieceType(piece);
-    const auto color = GetPieceColor(piece);
-
-    const auto king = MoveFromBitboard(GetKings(GetTurn()));
-    const auto numAttackers = CountPieces(GetAttacksOnSquare(king, GetOpponent()));
+    // Exclude board occupied by friendly pieces
+    possibleMoves &= ~friendly;
 
-    if (numAttackers > 0 && type == PieceType::King)
+    // en passant is checked on its own, it can uncover the king along a rank
+    Bitboard enPassant = kEmptyBitboard;
+    if (type == PieceType::Pawn && enPassantSquare != kNullSquare &&
+        (possibleMoves & MaskFromSquare(enPassantSquare)))
     {
-        if (numAttackers <= 2)
+        possibleMoves &= ~MaskFromSquare(enPassantSquare);
+        if (IsLegalEnPassant(square, masks))
         {
-            possibleMoves = GenerateKingMoves(square);
+            enPassant = MaskFromSquare(enPassantSquare);
         }
     }
-    else
-    {
-        const Bitboard blockers = GetOccupied(PieceColor::White) | GetOccupied(PieceColor::Black);
 
-        switch (type)
-        {
-        case PieceType::None:
-            break;
-        case PieceType::Pawn:
-            possibleMoves = GeneratePawnMoves(square);
-            break;
-        case PieceType::Knight:
-            possibleMoves = GenerateKnightMoves(square);
-            break;
-        case PieceType::Bishop:
-            possibleMoves = GenerateBishopMoves(square, blockers);
-            break;
-        case PieceType::Rook:
-            possibleMoves = GenerateRookMoves(square, blockers);
-            break;
-        case PieceType::Queen:
-            possibleMoves = GenerateQueenMoves(square, blockers);
-            break;
-        case PieceType::King:
-            possibleMoves = GenerateKingMoves(square);
-            break;
-        }
+    // pinned pieces may only slide along the line through the king
+    Bitboard allowed = masks.checkMask;
+    if (masks.pinned & MaskFromSquare(square))
+    {
+        allowed &= LineMasks[masks.king][square];
     }
 
-    // Exclude board occupied by friendly pieces
-    possibleMoves &= ~GetOccupied(color);
+    return (possibleMoves & allowed) | enPassant;
+}
 
-    // filter out moves that lead to check
-    Bitboard legal_moves = kEmptyBitboard;
-    for (auto to = 0; to < kNumSquares; ++to)
-    {
-        if (possibleMoves & MaskFromSquare(to) && !MoveLeadsToCheck(square, to))
-        {
-            legal_moves |= MaskFromSquare(to);
-        }
-    }
+uint64_t Chess::ComputeHash(void) const
+{
+    const auto epFile = (enPassantSquare == kNullSquare) ? -1 : (enPassantSquare % kNumFiles);
+    return ComputeZobristHash(board, turn, castlingRights, epFile);
+}
 
-    return legal_moves;
+uint64_t Chess::ComputePawnHash(void) const
+{
+    return ComputeZobristPawnHash(board);
 }
 
-void Chess::UpdateZobristMove(Piece moving,
-                              uint8_t from,
-                              uint8_t to,
-                              Piece captured,
-                              uint8_t enPassant,
-                              CastlingRights prevCastlingRights,
-                              CastlingRights newCastlingRights)
+uint64_t Chess::GetPolyglotKey(void) const
 {
-    hash ^= zobrist.side;              // flip side
-    hash ^= zobrist.psq[moving][from]; // remove piece from old square
-    hash ^= zobrist.psq[moving][to];   // add piece to new square
-    if (GetPieceType(captured) != PieceType::None)
-    {
-        hash ^= zobrist.psq[captured][to]; // remove captured piece
-    }
-    hash ^= zobrist.castling[static_cast<uint8_t>(prevCastlingRights)]; // remove old castling rights
-    hash ^= zobrist.castling[static_cast<uint8_t>(newCastlingRights)];  // add new castling rights
+    return ComputePolyglotKey(board, turn, castlingRights, enPassantSquare);
 }
 
 } // namespace chess
@@ -4,29 +4,55 @@
 #include <cctype>
 #include <cstdio>
 #include <string>
+#include <string_view>
 #include <vector>
 
+#include "eval.h"
+#include "fen.h"
+#include "move.h"
+#include "nnue.h"
 #include "piece.h"
 
 namespace chess
 {
 
-struct Move
-{
-    Piece piece;
-    uint8_t from;
-    uint8_t to;
-};
-
 struct Undo
 {
     Move move;
     Piece captured;
-    uint8_t enPassantCaptureSquare;
-    uint8_t oldEnPassant;
-    uint8_t newEnPassant;
-    CastlingRights oldCastlingRights;
-    CastlingRights newCastlingRights;
+    uint8_t enPassant;
+    CastlingRights castlingRights;
+    uint16_t halfmoveClock;
+};
+
+struct MoveMasks
+{
+    uint8_t king;
+    Bitboard checkers;  // enemy pieces giving check
+    Bitboard checkMask; // squares that resolve a single check, everything when not in check
+    Bitboard pinned;    // friendly pieces pinned to the king
+    Bitboard danger;    // squares attacked by the enemy, seen through the king
+};
+
+// Everything castling needs for one rights bit, worked out from the king and rook
+// squares when a position is set, so standard chess and Chess960 share one path.
+struct CastlingPath
+{
+    uint8_t king;
+    uint8_t rook;
+    uint8_t kingTo;
+    uint8_t rookTo;
+    bool xray;      // the rook may hide an enemy slider from the king's target
+    Bitboard empty; // squares either piece passes or lands on, apart from the two of them
+    Bitboard safe;  // the squares the king starts on, crosses and lands on
+};
+
+// captures hold every capture, en passant and promotion, quiets hold the rest
+enum class MoveGen : uint8_t
+{
+    All,
+    Captures,
+    Quiets,
 };
 
 class Chess
@@ -37,9 +63,11 @@ class Chess
     const char* GetSAN(const uint8_t square) const;
 
     void Clear(void);
-    void Load(const std::string& fen);
+    // leaves the position untouched when the FEN is rejected
+    FenError Load(std::string_view fen);
     void Reset(void);
-    bool MovePiece(uint8_t from, uint8_t to);
+    bool MovePiece(uint8_t from, uint8_t to, PieceType promotion = PieceType::Queen);
+    bool MovePiece(Move move);
     Piece GetPiece(uint8_t square) const;
     void PutPiece(Piece piece, uint8_t square);
     void RemovePiece(uint8_t square);
@@ -47,48 +75,75 @@ class Chess
     void Undo(void);
     void Redo(void);
 
+    // unchecked make/unmake for search and perft, the move must be legal
+    void MakeMove(Move move);
+    void UnmakeMove(void);
+
     const std::vector<Piece> GetBoard(void) const;
+    const std::string GetFEN(void) const;
     const std::string GetZobrist(void) const;
+    uint64_t GetHash(void) const { return hash; }
+    uint64_t GetPawnHash(void) const { return pawnHash; }
+    // computed on demand, only the opening book needs it
+    uint64_t GetPolyglotKey(void) const;
+    const Eval& GetEval(void) const { return eval; }
+
+    // the accumulator follows every piece change while a network is set, nullptr turns it off
+    void SetNetwork(const Network* network);
+    const Network* GetNetwork(void) const { return network; }
+    const Accumulator& GetAccumulator(void) const { return accumulator; }
 
     const Bitboard GetOccupied(PieceColor color) const;
+    const Bitboard GetPieces(PieceColor color, PieceType type) const { return pieces[static_cast<uint8_t>(color)][static_cast<uint8_t>(type)]; }
     const Bitboard GetAttacksOnSquare(uint8_t square, PieceColor from) const;
     const Bitboard GetAttacks(PieceColor from) const;
 
     const PieceColor GetTurn(void) const { return turn; }
     const PieceColor GetOpponent(void) const { return GetTurn() == PieceColor::White ? PieceColor::Black : PieceColor::White; }
     const PieceColor GetOpposite(PieceColor color) const { return color == PieceColor::White ? PieceColor::Black : PieceColor::White; }
-    void SetTurn(const PieceColor color) { turn = color; }
+    void SetTurn(const PieceColor color);
 
     const CastlingRights GetCastlingRights(void) const { return castlingRights; }
-    void SetCastlingRights(CastlingRights rights) { castlingRights |= rights; }
+    uint8_t GetEnPassantSquare(void) const { return enPassantSquare; }
+    void SetCastlingRights(CastlingRights rights);
+
+    uint16_t GetHalfmoveClock(void) const { return halfmoveClock; }
+    uint16_t GetFullmoveNumber(void) const { return fullmoveNumber; }
 
     bool InCheck(PieceColor turn) const;
     bool InCheckmate(void) const;
+    // The fifty-move rule, or the position has already been seen the given number of times
+    // since the last irreversible move. Games use 2 for threefold repetition, search uses 1.
+    bool IsDraw(int repetitions = 2) const;
+
+    void Moves(MoveList& moves, MoveGen gen = MoveGen::All) const;
+    void MovesFromSquare(uint8_t square, MoveList& moves) const;
+    void MovesForPiece(Piece piece, MoveList& moves) const;
+    bool IsLegal(Move move) const;
 
-    const std::vector<chess::Move> Moves() const;
-    const std::vector<chess::Move> MovesFromSquare(uint8_t square) const;
-    const std::vector<chess::Move> MovesForPiece(Piece piece) const;
+    // static exchange evaluation, the material won or lost by the capture sequence on the target square
+    int See(Move move) const;
 
   private:
-    bool IsValidMove(int from, int to) const;
-    bool IsCastlingMove(uint8_t from, uint8_t to, Piece movingPiece) const;
-    bool MoveLeadsToCheck(uint8_t from, uint8_t to) const;
+    void SetPosition(const FenPosition& position);
+    void MoveCastlingPieces(Move move, bool undo);
+    void AddMoves(MoveList& moves, uint8_t from, Bitboard targets) const;
+    void AddCastlingMoves(MoveList& moves, const MoveMasks& masks) const;
+    const MoveMasks ComputeMoveMasks(void) const;
+    bool IsLegalEnPassant(uint8_t from, const MoveMasks& masks) const;
+    const Bitboard GetAttacks(PieceColor from, const Bitboard occupancy) const;
+    const Bitboard GetAttacksOnSquare(uint8_t square, PieceColor from, const Bitboard occupancy) const;
 
     const Bitboard GeneratePawnMoves(uint8_t square) const;
     const Bitboard GenerateKnightMoves(uint8_t square) const;
     const Bitboard GenerateBishopMoves(uint8_t square, const Bitboard blockers) const;
     const Bitboard GenerateRookMoves(uint8_t square, const Bitboard blockers) const;
     const Bitboard GenerateQueenMoves(uint8_t square, const Bitboard blockers) const;
-    const Bitboard GenerateKingMoves(uint8_t square) const;
-    const Bitboard GenerateMovesForPieceAt(const Piece piece, uint8_t square) const;
+    const Bitboard GenerateKingMoves(uint8_t square, const Bitboard danger) const;
+    const Bitboard GenerateLegalMoves(uint8_t square, const MoveMasks& masks) const;
 
-    void UpdateZobristMove(Piece moving,
-                           uint8_t from,
-                           uint8_t to,
-                           Piece captured,
-                           uint8_t enPassant,
-                           CastlingRights prevCastlingRights,
-                           CastlingRights newCastlingRights);
+    uint64_t ComputeHash(void) const;
+    uint64_t ComputePawnHash(void) const;
 
     inline constexpr const Bitboard GetPawns(PieceColor turn) const
     {
@@ -123,14 +178,24 @@ class Chess
   private:
     PieceColor turn;
     CastlingRights castlingRights;
+    std::array<CastlingPath, kNumCastlings> castlingPaths;
+    std::array<CastlingRights, kNumSquares> castlingRightsKept; // rights left after a move from or to the square
     uint8_t enPassantSquare;
+    uint16_t halfmoveClock;
+    uint16_t fullmoveNumber;
 
     Piece board[kNumSquares];
     Bitboard pieces[kNumColors][kNumPieces];
 
     uint64_t hash;
-    std::vector<chess::Undo> undoStack;
-    std::vector<chess::Undo> redoStack;
+    uint64_t pawnHash;
+    Eval eval;
+    Accumulator accumulator;
+    const Network* network;
+    std::array<chess::Undo, kMaxGamePly + kMaxSearchPly> states;
+    std::array<uint64_t, kMaxGamePly + kMaxSearchPly> hashHistory; // the hash before each move in states
+    uint16_t numStates;
+    std::vector<chess::Move> redoStack;
 };
 
 } // namespace chess
\ No newline at end of file
@@ -5,7 +5,6 @@ namespace chess
 
 using Bitboard = uint64_t;
 
-constexpr const char* KEmptyPostion = "8/8/8/8/8/8/8/8 w - - 0 1";
 constexpr const char* kDefaultPosition = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
 
 constexpr const char kPawn = 'p';
@@ -34,10 +33,27 @@ constexpr const int kNumRanks = 8; // x
 constexpr const int kNumFiles = 8; // y
 constexpr const int kNumSquares = kNumRanks * kNumFiles;
 constexpr const int kNumPieces = 12;
+constexpr const int kNumPieceTypes = 6;
 constexpr const int kNumColors = 2;
 
+// no legal position has more than 218 moves
+constexpr const int kMaxMoves = 256;
+
+// plies of history kept for undo, a search may add kMaxSearchPly on top
+constexpr const int kMaxGamePly = 2048;
+constexpr const int kMaxSearchPly = 128;
+
+// emscripten only has threads when built with -pthread
+#if defined(__EMSCRIPTEN__) && !defined(__EMSCRIPTEN_PTHREADS__)
+constexpr const bool kThreadsAvailable = false;
+#else
+constexpr const bool kThreadsAvailable = true;
+#endif
+
 // bitboard
 constexpr const uint64_t kEmptyBitboard = 0ULL;
+constexpr const uint64_t kBackRanks = 0xFF000000000000FFULL;
+constexpr const uint64_t kLightSquares = 0x55AA55AA55AA55AAULL;
 
 // zobrist
 constexpr const int kCastlingBits = 16;
@@ -0,0 +1,447 @@
+#include "fen.h"
+#include "bitboard.h"
+
+#include <algorithm>
+#include <charconv>
+
+namespace chess
+{
+
+namespace
+{
+
+constexpr bool IsSpace(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+// splits off the next whitespace separated field, empty at the end of the input
+std::string_view NextField(std::string_view& rest)
+{
+    size_t start = 0;
+    while (start < rest.size() && IsSpace(rest[start]))
+    {
+        ++start;
+    }
+    size_t end = start;
+    while (end < rest.size() && !IsSpace(rest[end]))
+    {
+        ++end;
+    }
+
+    const auto field = rest.substr(start, end - start);
+    rest.remove_prefix(end);
+    return field;
+}
+
+constexpr PieceType PieceTypeFromChar(char c)
+{
+    switch (c)
+    {
+    case kPawn:
+        return PieceType::Pawn;
+    case kKnight:
+        return PieceType::Knight;
+    case kBishop:
+        return PieceType::Bishop;
+    case kRook:
+        return PieceType::Rook;
+    case kQueen:
+        return PieceType::Queen;
+    case kKing:
+        return PieceType::King;
+    default:
+        return PieceType::None;
+    }
+}
+
+constexpr char CharFromPiece(Piece piece)
+{
+    constexpr const char kChars[] = " pnbrqk";
+    const auto c = kChars[static_cast<uint8_t>(GetPieceType(piece))];
+    return GetPieceColor(piece) == PieceColor::White ? static_cast<char>(c - 'a' + 'A') : c;
+}
+
+bool ParsePlacement(std::string_view field, std::array<Piece, kNumSquares>& board)
+{
+    auto rank = 0;
+    auto file = 0;
+    auto lastWasDigit = false;
+
+    for (const auto c : field)
+    {
+        if (c == '/')
+        {
+            if (file != kNumFiles || ++rank >= kNumRanks)
+            {
+                return false;
+            }
+            file = 0;
+            lastWasDigit = false;
+        }
+        else if (c >= '1' && c <= '8')
+        {
+            // two digits in a row are never written, and a rank can't run over
+            if (lastWasDigit || file + (c - '0') > kNumFiles)
+            {
+                return false;
+            }
+            file += c - '0';
+            lastWasDigit = true;
+        }
+        else
+        {
+            const auto lower = static_cast<char>((c >= 'A' && c <= 'Z') ? c - 'A' + 'a' : c);
+            const auto type = PieceTypeFromChar(lower);
+            if (type == PieceType::None || file >= kNumFiles)
+            {
+                return false;
+            }
+            const auto color = (c == lower) ? PieceColor::Black : PieceColor::White;
+            board[rank * kNumFiles + file++] = MakePiece(color, type);
+            lastWasDigit = false;
+        }
+    }
+
+    return rank == kNumRanks - 1 && file == kNumFiles;
+}
+
+// kNullSquare when the king isn't on its back rank
+uint8_t FindBackRankKing(const std::array<Piece, kNumSquares>& board, PieceColor color)
+{
+    const auto rank = color == PieceColor::White ? (kNumRanks - 1) * kNumFiles : 0;
+    for (auto file = 0; file < kNumFiles; ++file)
+    {
+        if (board[rank + file] == MakePiece(color, PieceType::King))
+        {
+            return static_cast<uint8_t>(rank + file);
+        }
+    }
+    return kNullSquare;
+}
+
+// the square of the outermost rook on one side of the king on its back rank, kNullSquare when there is none
+uint8_t FindCastlingRook(const std::array<Piece, kNumSquares>& board, uint8_t king, bool kingSide)
+{
+    const auto rook = MakePiece(GetPieceColor(board[king]), PieceType::Rook);
+    const auto rank = king - king % kNumFiles;
+    for (auto file = kingSide ? kNumFiles - 1 : 0; file != king % kNumFiles; file += kingSide ? -1 : 1)
+    {
+        if (board[rank + file] == rook)
+        {
+            return static_cast<uint8_t>(rank + file);
+        }
+    }
+    return kNullSquare;
+}
+
+bool ParseCastling(std::string_view field, const std::array<Piece, kNumSquares>& board, CastlingRights& rights,
+                   std::array<uint8_t, kNumCastlings>& rooks)
+{
+    rights = CastlingRights::None;
+    rooks.fill(kNullSquare);
+    if (field == "-")
+    {
+        return true;
+    }
+    if (field.empty())
+    {
+        return false;
+    }
+
+    for (const auto c : field)
+    {
+        const auto white = c >= 'A' && c <= 'Z';
+        const auto lower = static_cast<char>(white ? c - 'A' + 'a' : c);
+        const auto color = white ? PieceColor::White : PieceColor::Black;
+
+        // the king has to be on its back rank
+        const auto king = FindBackRankKing(board, color);
+        if (king == kNullSquare)
+        {
+            return false;
+        }
+        const auto rank = king - king % kNumFiles;
+
+        auto rook = kNullSquare;
+        if (lower == kKing || lower == kQueen)
+        {
+            rook = FindCastlingRook(board, king, lower == kKing);
+        }
+        else if (lower >= 'a' && lower <= 'h' && board[rank + lower - 'a'] == MakePiece(color, PieceType::Rook))
+        {
+            rook = static_cast<uint8_t>(rank + lower - 'a');
+        }
+        if (rook == kNullSquare)
+        {
+            return false;
+        }
+
+        // no repeats
+        const auto index = (white ? 0 : 2) + (rook < king ? 1 : 0);
+        const auto right = static_cast<CastlingRights>(1 << index);
+        if (Has(rights, right))
+        {
+            return false;
+        }
+        rights |= right;
+        rooks[index] = rook;
+    }
+    return true;
+}
+
+bool ParseEnPassant(std::string_view field, const std::array<Piece, kNumSquares>& board, PieceColor turn, uint8_t& square)
+{
+    square = kNullSquare;
+    if (field == "-")
+    {
+        return true;
+    }
+    if (field.size() != 2 || field[0] < 'a' || field[0] > 'h')
+    {
+        return false;
+    }
+
+    // the target is behind a pawn that just moved two squares, and both squares it crossed are empty
+    const auto white = turn == PieceColor::White;
+    if (field[1] != (white ? '6' : '3'))
+    {
+        return false;
+    }
+
+    const auto target = static_cast<uint8_t>((kNumRanks - (field[1] - '0')) * kNumFiles + (field[0] - 'a'));
+    const auto pawn = white ? target + kNumFiles : target - kNumFiles;
+    const auto start = white ? target - kNumFiles : target + kNumFiles;
+    if (board[pawn] != MakePiece(white ? PieceColor::Black : PieceColor::White, PieceType::Pawn) ||
+        board[target] != kNullPiece || board[start] != kNullPiece)
+    {
+        return false;
+    }
+
+    square = target;
+    return true;
+}
+
+bool ParseNumber(std::string_view field, uint16_t& value)
+{
+    const auto* end = field.data() + field.size();
+    const auto result = std::from_chars(field.data(), end, value);
+    return !field.empty() && result.ec == std::errc() && result.ptr == end;
+}
+
+FenError ValidatePosition(const FenPosition& position)
+{
+    std::array<std::array<Bitboard, kNumPieceTypes + 1>, kNumColors> pieces = {};
+    Bitboard occupancy = kEmptyBitboard;
+
+    for (auto sq = 0; sq < kNumSquares; ++sq)
+    {
+        const auto piece = position.board[sq];
+        if (piece != kNullPiece)
+        {
+            pieces[static_cast<uint8_t>(GetPieceColor(piece))][static_cast<uint8_t>(GetPieceType(piece))] |= MaskFromSquare(sq);
+            occupancy |= MaskFromSquare(sq);
+        }
+    }
+
+    constexpr auto king = static_cast<uint8_t>(PieceType::King);
+    constexpr auto pawn = static_cast<uint8_t>(PieceType::Pawn);
+    if (CountPieces(pieces[0][king]) != 1 || CountPieces(pieces[1][king]) != 1)
+    {
+        return FenError::Kings;
+    }
+    if ((pieces[0][pawn] | pieces[1][pawn]) & kBackRanks)
+    {
+        return FenError::Pawns;
+    }
+
+    // the side that just moved can't have left its king in check
+    const auto us = static_cast<uint8_t>(position.turn);
+    const auto& attackers = pieces[us];
+    const auto target = MoveFromBitboard(pieces[us ^ 1][king]);
+    const auto queens = attackers[static_cast<uint8_t>(PieceType::Queen)];
+
+    Bitboard checks = kEmptyBitboard;
+    checks |= (position.turn == PieceColor::White ? BlackPawnCaptureMasks[target] : WhitePawnCaptureMasks[target]) & attackers[pawn];
+    checks |= KnightMasks[target] & attackers[static_cast<uint8_t>(PieceType::Knight)];
+    checks |= KingMasks[target] & attackers[king];
+    checks |= BishopMask(target, occupancy) & (attackers[static_cast<uint8_t>(PieceType::Bishop)] | queens);
+    checks |= RookMask(target, occupancy) & (attackers[static_cast<uint8_t>(PieceType::Rook)] | queens);
+
+    return checks ? FenError::OpponentInCheck : FenError::None;
+}
+
+char* WriteNumber(char* out, uint16_t value)
+{
+    return std::to_chars(out, out + 5, value).ptr;
+}
+
+} // namespace
+
+FenError ParseFEN(std::string_view fen, FenPosition& position)
+{
+    FenPosition parsed = {};
+    parsed.board.fill(kNullPiece);
+
+    if (!ParsePlacement(NextField(fen), parsed.board))
+    {
+        return FenError::Placement;
+    }
+
+    const auto side = NextField(fen);
+    if (side.size() != 1 || (side[0] != kWhite && side[0] != kBlack))
+    {
+        return FenError::SideToMove;
+    }
+    parsed.turn = side[0] == kWhite ? PieceColor::White : PieceColor::Black;
+
+    if (!ParseCastling(NextField(fen), parsed.board, parsed.castlingRights, parsed.castlingRooks))
+    {
+        return FenError::Castling;
+    }
+
+    if (!ParseEnPassant(NextField(fen), parsed.board, parsed.turn, parsed.enPassant))
+    {
+        return FenError::EnPassant;
+    }
+
+    // the clocks come as a pair or not at all
+    parsed.halfmoveClock = 0;
+    parsed.fullmoveNumber = 1;
+    const auto halfmove = NextField(fen);
+    if (!halfmove.empty())
+    {
+        if (!ParseNumber(halfmove, parsed.halfmoveClock))
+        {
+            return FenError::HalfmoveClock;
+        }
+        if (!ParseNumber(NextField(fen), parsed.fullmoveNumber) || parsed.fullmoveNumber == 0)
+        {
+            return FenError::FullmoveNumber;
+        }
+    }
+
+    if (!NextField(fen).empty())
+    {
+        return FenError::TrailingInput;
+    }
+
+    const auto error = ValidatePosition(parsed);
+    if (error == FenError::None)
+    {
+        position = parsed;
+    }
+    return error;
+}
+
+size_t WriteFEN(const FenPosition& position, char* out)
+{
+    auto* p = out;
+
+    for (auto rank = 0; rank < kNumRanks; ++rank)
+    {
+        auto empty = 0;
+        for (auto file = 0; file < kNumFiles; ++file)
+        {
+            const auto piece = position.board[rank * kNumFiles + file];
+            if (piece == kNullPiece)
+            {
+                ++empty;
+                continue;
+            }
+            if (empty > 0)
+            {
+                *p++ = static_cast<char>('0' + empty);
+                empty = 0;
+            }
+            *p++ = CharFromPiece(piece);
+        }
+        if (empty > 0)
+        {
+            *p++ = static_cast<char>('0' + empty);
+        }
+        if (rank < kNumRanks - 1)
+        {
+            *p++ = '/';
+        }
+    }
+
+    *p++ = ' ';
+    *p++ = position.turn == PieceColor::White ? kWhite : kBlack;
+
+    *p++ = ' ';
+    if (position.castlingRights == CastlingRights::None)
+    {
+        *p++ = '-';
+    }
+    else
+    {
+        // KQkq while the rook is the outermost one, which covers every standard position,
+        // and the rook's file otherwise
+        for (auto i = 0; i < kNumCastlings; ++i)
+        {
+            const auto rook = position.castlingRooks[i];
+            if (!Has(position.castlingRights, static_cast<CastlingRights>(1 << i)) || rook == kNullSquare)
+            {
+                continue;
+            }
+
+            const auto kingSide = i % 2 == 0;
+            const auto king = FindBackRankKing(position.board, i < 2 ? PieceColor::White : PieceColor::Black);
+            const auto outermost = king == kNullSquare || FindCastlingRook(position.board, king, kingSide) == rook;
+            const auto symbol = outermost ? (kingSide ? kKing : kQueen) : static_cast<char>('a' + rook % kNumFiles);
+            *p++ = i < 2 ? static_cast<char>(symbol - 'a' + 'A') : symbol;
+        }
+    }
+
+    *p++ = ' ';
+    if (position.enPassant == kNullSquare)
+    {
+        *p++ = '-';
+    }
+    else
+    {
+        *p++ = kSANPositions[position.enPassant][0];
+        *p++ = kSANPositions[position.enPassant][1];
+    }
+
+    *p++ = ' ';
+    p = WriteNumber(p, position.halfmoveClock);
+    *p++ = ' ';
+    p = WriteNumber(p, position.fullmoveNumber);
+    *p = '\0';
+
+    return static_cast<size_t>(p - out);
+}
+
+const char* GetFenErrorMessage(FenError error)
+{
+    switch (error)
+    {
+    case FenError::None:
+        return "ok";
+    case FenError::Placement:
+        return "invalid piece placement";
+    case FenError::SideToMove:
+        return "invalid side to move";
+    case FenError::Castling:
+        return "invalid castling rights";
+    case FenError::EnPassant:
+        return "invalid en passant square";
+    case FenError::HalfmoveClock:
+        return "invalid halfmove clock";
+    case FenError::FullmoveNumber:
+        return "invalid fullmove number";
+    case FenError::TrailingInput:
+        return "unexpected input after the fullmove number";
+    case FenError::Kings:
+        return "each side needs exactly one king";
+    case FenError::Pawns:
+        return "pawns can't stand on the first or last rank";
+    case FenError::OpponentInCheck:
+        return "the side not to move is in check";
+    }
+    return "unknown error";
+}
+
+} // namespace chess
@@ -1,168 +1,56 @@
 #pragma once
 
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
 #include "piece.h"
-#include <string>
 
 namespace chess
 {
 
-static void loadFromFEN(const std::string& fen, Chess* chess)
-{
-    auto index = 0;
-    auto i = 0;
-
-    // Parse piece placement
-    for (; i < fen.size() && index < 64; ++i)
-    {
-        auto c = fen[i];
-        if (c == ' ')
-        {
-            break;
-        }
-
-        if (c == '/')
-        {
-            continue;
-        }
-        else if (std::isdigit(c))
-        {
-            auto emptyCount = c - '0';
-            for (auto j = 0; j < emptyCount; ++j)
-            {
-                chess->PutPiece(kNullPiece, index++);
-            }
-        }
-        else
-        {
-            auto type = PieceType::None;
-            auto color = std::isupper(c) ? PieceColor::White : PieceColor::Black;
-
-            auto lower = std::tolower(c);
-            switch (lower)
-            {
-            case kPawn:
-                type = PieceType::Pawn;
-                break;
-            case kKnight:
-                type = PieceType::Knight;
-                break;
-            case kBishop:
-                type = PieceType::Bishop;
-                break;
-            case kRook:
-                type = PieceType::Rook;
-                break;
-            case kQueen:
-                type = PieceType::Queen;
-                break;
-            case kKing:
-                type = PieceType::King;
-                break;
-            default:
-                type = PieceType::None;
-                break;
-            }
-
-            auto piece = MakePiece(color, type);
-            chess->PutPiece(piece, index++);
-        }
-    }
-
-    if (fen[i] == ' ')
-    {
-        ++i;
-    }
-
-    // Parse active color
-    char sideToMove = fen[i];
-    if (sideToMove == kWhite)
-    {
-        printf("Side to move: White\n");
-        chess->SetTurn(PieceColor::White);
-    }
-    else if (sideToMove == kBlack)
-    {
-        printf("Side to move: Black\n");
-        chess->SetTurn(PieceColor::Black);
-    }
-    ++i; // move past 'w' or 'b'
-
-    if (fen[i] == ' ')
-    {
-        ++i;
-    }
-
-    // Parse castling rights
-    std::string castlingRights;
-    while (i < fen.size() && fen[i] != ' ')
-    {
-        castlingRights += fen[i++];
-    }
-
-    printf("Castling rights: %s\n", castlingRights.c_str());
-    printf("White can castle kingside: %d\n", (castlingRights.find(kWhiteKing) != std::string::npos));
-    printf("White can castle queenside: %d\n", (castlingRights.find(kWhiteQueen) != std::string::npos));
-    printf("Black can castle kingside: %d\n", (castlingRights.find(kBlackKing) != std::string::npos));
-    printf("Black can castle queenside: %d\n", (castlingRights.find(kBlackQueen) != std::string::npos));
+// longest possible FEN plus the terminator
+constexpr const size_t kMaxFenLength = 100;
 
-    if (castlingRights.find(kWhiteKing) != std::string::npos)
-    {
-        chess->SetCastlingRights(CastlingRights::WhiteKingSide);
-    }
-    if (castlingRights.find(kWhiteQueen) != std::string::npos)
-    {
-        chess->SetCastlingRights(CastlingRights::WhiteQueenSide);
-    }
-    if (castlingRights.find(kBlackKing) != std::string::npos)
-    {
-        chess->SetCastlingRights(CastlingRights::BlackKingSide);
-    }
-    if (castlingRights.find(kBlackQueen) != std::string::npos)
-    {
-        chess->SetCastlingRights(CastlingRights::BlackQueenSide);
-    }
+// one per castling rights bit: white king-side, white queen-side, black king-side, black queen-side
+constexpr const int kNumCastlings = 4;
 
-    if (fen[i] == ' ')
-    {
-        ++i;
-    }
-
-    // Parse en passant target
-    std::string epSquare;
-    while (i < fen.size() && fen[i] != ' ')
-    {
-        epSquare += fen[i++];
-    }
-
-    printf("En passant target: %s\n", epSquare.c_str());
-
-    if (fen[i] == ' ')
-    {
-        ++i;
-    }
-
-    // Parse halfmove clock
-    std::string halfmoveStr;
-    while (i < fen.size() && fen[i] != ' ')
-    {
-        halfmoveStr += fen[i++];
-    }
-
-    printf("Halfmove clock: %d\n", std::stoi(halfmoveStr));
-
-    if (fen[i] == ' ')
-    {
-        ++i;
-    }
-
-    // Parse fullmove number
-    std::string fullmoveStr;
-    while (i < fen.size() && fen[i] != ' ')
-    {
-        fullmoveStr += fen[i++];
-    }
-
-    printf("Fullmove number: %d\n", std::stoi(fullmoveStr));
-}
+enum class FenError : uint8_t
+{
+    None = 0,
+    Placement,
+    SideToMove,
+    Castling,
+    EnPassant,
+    HalfmoveClock,
+    FullmoveNumber,
+    TrailingInput,
+    Kings,
+    Pawns,
+    OpponentInCheck,
+};
+
+struct FenPosition
+{
+    std::array<Piece, kNumSquares> board;
+    PieceColor turn;
+    CastlingRights castlingRights;
+    std::array<uint8_t, kNumCastlings> castlingRooks; // kNullSquare for each right not held
+    uint8_t enPassant;                                // kNullSquare when there is none
+    uint16_t halfmoveClock;
+    uint16_t fullmoveNumber;
+};
+
+// Parses and validates without allocating. The move clocks may be left out,
+// as in EPD, and default to 0 and 1. Castling takes KQkq for the outermost rook
+// on each side of the king, or the rook's file (Shredder-FEN) for Chess960.
+// position is only written on success.
+FenError ParseFEN(std::string_view fen, FenPosition& position);
+
+// writes a null terminated FEN and returns its length, out must hold kMaxFenLength chars
+size_t WriteFEN(const FenPosition& position, char* out);
+
+const char* GetFenErrorMessage(FenError error);
 
 } // namespace chess
@@ -0,0 +1,96 @@
+#include "mapped.h"
+
+#include <fstream>
+#include <iterator>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define CHESS_HAS_MMAP 1
+#endif
+
+namespace chess
+{
+
+MappedFile::MappedFile() : data(nullptr), size(0), mapped(false)
+{
+}
+
+MappedFile::~MappedFile()
+{
+    Close();
+}
+
+bool MappedFile::Open(const std::string& path, bool sequential)
+{
+    Close();
+
+#if defined(CHESS_HAS_MMAP)
+    const auto fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        return false;
+    }
+
+    struct stat info;
+    if (::fstat(fd, &info) != 0)
+    {
+        ::close(fd);
+        return false;
+    }
+
+    // mmap refuses empty files, which are still valid input
+    if (info.st_size == 0)
+    {
+        ::close(fd);
+        return true;
+    }
+
+    auto* view = ::mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (view != MAP_FAILED)
+    {
+#if defined(MADV_SEQUENTIAL)
+        if (sequential)
+        {
+            ::madvise(view, static_cast<size_t>(info.st_size), MADV_SEQUENTIAL);
+        }
+#endif
+        data = static_cast<const uint8_t*>(view);
+        size = static_cast<size_t>(info.st_size);
+        mapped = true;
+        return true;
+    }
+#else
+    (void)sequential;
+#endif
+
+    std::ifstream file(path, std::ios::binary);
+    if (!file)
+    {
+        return false;
+    }
+    buffer.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    data = buffer.data();
+    size = buffer.size();
+    return true;
+}
+
+void MappedFile::Close(void)
+{
+#if defined(CHESS_HAS_MMAP)
+    if (mapped)
+    {
+        ::munmap(const_cast<uint8_t*>(data), size);
+    }
+#endif
+    buffer.clear();
+    buffer.shrink_to_fit();
+    data = nullptr;
+    size = 0;
+    mapped = false;
+}
+
+} // namespace chess
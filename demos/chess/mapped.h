@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace chess
+{
+
+// Read only view of a whole file. POSIX systems map it so multi-GB inputs
+// cost no heap, elsewhere the file is read into memory.
+class MappedFile
+{
+  public:
+    MappedFile();
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // sequential hints the kernel to read ahead for front to back scans
+    bool Open(const std::string& path, bool sequential = false);
+    void Close(void);
+
+    const uint8_t* GetData(void) const { return data; }
+    size_t GetSize(void) const { return size; }
+
+  private:
+    const uint8_t* data;
+    size_t size;
+    bool mapped;
+    std::vector<uint8_t> buffer;
+};
+
+} // namespace chess
@@ -0,0 +1,134 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "piece.h"
+
+namespace chess
+{
+
+enum class MoveFlag : uint8_t
+{
+    Quiet = 0,
+    DoublePawnPush = 1,
+    KingCastle = 2,
+    QueenCastle = 3,
+    Capture = 4,
+    EnPassant = 5,
+    KnightPromotion = 8,
+    BishopPromotion = 9,
+    RookPromotion = 10,
+    QueenPromotion = 11,
+    KnightPromotionCapture = 12,
+    BishopPromotionCapture = 13,
+    RookPromotionCapture = 14,
+    QueenPromotionCapture = 15,
+};
+
+constexpr const uint16_t kMoveSquareMask = 0b111111;
+constexpr const uint8_t kMoveToShift = 6;
+constexpr const uint8_t kMoveFlagShift = 12;
+constexpr const uint8_t kMoveCaptureFlag = 0b0100;
+constexpr const uint8_t kMovePromotionFlag = 0b1000;
+
+// from (6 bits) | to (6 bits) | flag (4 bits)
+struct Move
+{
+    uint16_t data;
+
+    Move() = default;
+
+    constexpr Move(uint8_t from, uint8_t to, MoveFlag flag = MoveFlag::Quiet)
+        : data(static_cast<uint16_t>(from | (to << kMoveToShift) | (static_cast<uint8_t>(flag) << kMoveFlagShift)))
+    {
+    }
+
+    constexpr uint8_t From(void) const { return data & kMoveSquareMask; }
+    constexpr uint8_t To(void) const { return (data >> kMoveToShift) & kMoveSquareMask; }
+    constexpr MoveFlag Flag(void) const { return static_cast<MoveFlag>(data >> kMoveFlagShift); }
+
+    constexpr bool IsCapture(void) const { return (static_cast<uint8_t>(Flag()) & kMoveCaptureFlag) != 0; }
+    constexpr bool IsPromotion(void) const { return (static_cast<uint8_t>(Flag()) & kMovePromotionFlag) != 0; }
+    constexpr bool IsEnPassant(void) const { return Flag() == MoveFlag::EnPassant; }
+    constexpr bool IsDoublePawnPush(void) const { return Flag() == MoveFlag::DoublePawnPush; }
+    constexpr bool IsCastling(void) const { return Flag() == MoveFlag::KingCastle || Flag() == MoveFlag::QueenCastle; }
+
+    // knight, bishop, rook, queen follow each other in both enums
+    constexpr PieceType Promotion(void) const
+    {
+        return IsPromotion()
+                   ? static_cast<PieceType>(static_cast<uint8_t>(PieceType::Knight) + (static_cast<uint8_t>(Flag()) & 0b11))
+                   : PieceType::None;
+    }
+
+    constexpr bool operator==(const Move& other) const { return data == other.data; }
+};
+
+static_assert(sizeof(Move) == 2);
+
+constexpr const Move kNullMove = Move(0, 0);
+
+// long algebraic notation as used by UCI, e.g. e2e4 or a7a8q
+inline const std::string MoveToUCI(const Move move)
+{
+    if (move == kNullMove)
+    {
+        return "0000";
+    }
+
+    std::string uci = std::string(kSANPositions[move.From()]) + kSANPositions[move.To()];
+    switch (move.Promotion())
+    {
+    case PieceType::Knight:
+        uci += kKnight;
+        break;
+    case PieceType::Bishop:
+        uci += kBishop;
+        break;
+    case PieceType::Rook:
+        uci += kRook;
+        break;
+    case PieceType::Queen:
+        uci += kQueen;
+        break;
+    default:
+        break;
+    }
+    return uci;
+}
+
+constexpr MoveFlag MakePromotionFlag(PieceType promotion, bool capture)
+{
+    return static_cast<MoveFlag>(kMovePromotionFlag |
+                                 (capture ? kMoveCaptureFlag : 0) |
+                                 (static_cast<uint8_t>(promotion) - static_cast<uint8_t>(PieceType::Knight)));
+}
+
+// fixed capacity, stack allocated list used by the move generator
+class MoveList
+{
+  public:
+    MoveList() = default;
+
+    inline void push_back(const Move& move) { moves[count++] = move; }
+    inline void clear(void) { count = 0; }
+
+    inline size_t size(void) const { return count; }
+    inline bool empty(void) const { return count == 0; }
+
+    inline Move& operator[](size_t i) { return moves[i]; }
+    inline const Move& operator[](size_t i) const { return moves[i]; }
+
+    inline Move* begin(void) { return moves; }
+    inline Move* end(void) { return moves + count; }
+    inline const Move* begin(void) const { return moves; }
+    inline const Move* end(void) const { return moves + count; }
+
+  private:
+    Move moves[kMaxMoves];
+    size_t count = 0;
+};
+
+} // namespace chess
@@ -0,0 +1,169 @@
+#include "movepicker.h"
+
+#include <utility>
+
+namespace chess
+{
+
+MovePicker::MovePicker(const Chess& chess, Move ttMove, const Killers& killers, const HistoryTable& history)
+    : chess(chess), history(history), ttMove(ttMove), killers(killers), quiescence(false), stage(Stage::TTMove),
+      current(0), currentBad(0), currentKiller(0)
+{
+    if (ttMove == kNullMove || !chess.IsLegal(ttMove))
+    {
+        this->ttMove = kNullMove;
+        stage = Stage::GenerateCaptures;
+    }
+}
+
+MovePicker::MovePicker(const Chess& chess, Move ttMove, const HistoryTable& history)
+    : chess(chess), history(history), ttMove(ttMove), killers{kNullMove, kNullMove}, quiescence(true),
+      stage(Stage::TTMove), current(0), currentBad(0), currentKiller(0)
+{
+    if (ttMove == kNullMove || !(ttMove.IsCapture() || ttMove.IsPromotion()) || !chess.IsLegal(ttMove))
+    {
+        this->ttMove = kNullMove;
+        stage = Stage::GenerateCaptures;
+    }
+}
+
+Move MovePicker::Next(void)
+{
+    switch (stage)
+    {
+    case Stage::TTMove:
+        stage = Stage::GenerateCaptures;
+        return ttMove;
+
+    case Stage::GenerateCaptures:
+        chess.Moves(moves, MoveGen::Captures);
+        ScoreCaptures();
+        current = 0;
+        stage = Stage::GoodCaptures;
+        [[fallthrough]];
+
+    case Stage::GoodCaptures:
+        while (current < moves.size())
+        {
+            const auto move = PickBest();
+            if (move == ttMove)
+            {
+                continue;
+            }
+            if (!IsGoodCapture(move))
+            {
+                badCaptures.push_back(move);
+                continue;
+            }
+            return move;
+        }
+        // quiescence drops the losing captures altogether
+        stage = quiescence ? Stage::Done : Stage::Killers;
+        return Next();
+
+    case Stage::Killers:
+        while (currentKiller < kNumKillers)
+        {
+            const auto killer = killers[currentKiller++];
+            if (killer != kNullMove && killer != ttMove && !IsSpecial(killer) && chess.IsLegal(killer))
+            {
+                return killer;
+            }
+        }
+        stage = Stage::GenerateQuiets;
+        [[fallthrough]];
+
+    case Stage::GenerateQuiets:
+        chess.Moves(moves, MoveGen::Quiets);
+        ScoreQuiets();
+        current = 0;
+        stage = Stage::Quiets;
+        [[fallthrough]];
+
+    case Stage::Quiets:
+        while (current < moves.size())
+        {
+            const auto move = PickBest();
+            if (move == ttMove || move == killers[0] || move == killers[1])
+            {
+                continue;
+            }
+            return move;
+        }
+        stage = Stage::BadCaptures;
+        [[fallthrough]];
+
+    case Stage::BadCaptures:
+        if (currentBad < badCaptures.size())
+        {
+            return badCaptures[currentBad++];
+        }
+        stage = Stage::Done;
+        [[fallthrough]];
+
+    case Stage::Done:
+        break;
+    }
+
+    return kNullMove;
+}
+
+void MovePicker::ScoreCaptures(void)
+{
+    for (size_t i = 0; i < moves.size(); ++i)
+    {
+        const auto move = moves[i];
+        const auto attacker = GetPieceType(chess.GetPiece(move.From()));
+        const auto victim = move.IsEnPassant() ? PieceType::Pawn : GetPieceType(chess.GetPiece(move.To()));
+
+        // most valuable victim, least valuable attacker
+        auto score = 10 * kPieceValues[static_cast<uint8_t>(victim)] - static_cast<uint8_t>(attacker);
+        if (move.IsPromotion())
+        {
+            score += 10 * kPieceValues[static_cast<uint8_t>(move.Promotion())];
+        }
+        scores[i] = score;
+    }
+}
+
+void MovePicker::ScoreQuiets(void)
+{
+    const auto& table = history[static_cast<uint8_t>(chess.GetTurn())];
+    for (size_t i = 0; i < moves.size(); ++i)
+    {
+        scores[i] = table[moves[i].From()][moves[i].To()];
+    }
+}
+
+bool MovePicker::IsGoodCapture(Move move) const
+{
+    // under promotions are almost never best, try them last
+    if (move.IsPromotion() && move.Promotion() != PieceType::Queen)
+    {
+        return false;
+    }
+    return chess.See(move) >= 0;
+}
+
+bool MovePicker::IsSpecial(Move move) const
+{
+    return move.IsCapture() || move.IsPromotion();
+}
+
+// selection sort one step at a time, most nodes cut off after the first few moves
+Move MovePicker::PickBest(void)
+{
+    auto best = current;
+    for (auto j = current + 1; j < moves.size(); ++j)
+    {
+        if (scores[j] > scores[best])
+        {
+            best = j;
+        }
+    }
+    std::swap(moves[current], moves[best]);
+    std::swap(scores[current], scores[best]);
+    return moves[current++];
+}
+
+} // namespace chess
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+#include "chess.h"
+
+namespace chess
+{
+
+constexpr const int kNumKillers = 2;
+constexpr const int kMaxHistory = 16384;
+
+using Killers = std::array<Move, kNumKillers>;
+
+// butterfly history, indexed by [color][from][to]
+using HistoryTable = std::array<std::array<std::array<int, kNumSquares>, kNumSquares>, kNumColors>;
+
+// nudges towards the bonus and saturates at kMaxHistory
+inline void UpdateHistory(int& entry, int bonus)
+{
+    const auto clamped = bonus < -kMaxHistory ? -kMaxHistory : (bonus > kMaxHistory ? kMaxHistory : bonus);
+    entry += clamped - entry * (clamped < 0 ? -clamped : clamped) / kMaxHistory;
+}
+
+enum class Stage : uint8_t
+{
+    TTMove,
+    GenerateCaptures,
+    GoodCaptures,
+    Killers,
+    GenerateQuiets,
+    Quiets,
+    BadCaptures,
+    Done,
+};
+
+// hands out moves best first and only generates a stage once the previous one is used up
+class MovePicker
+{
+  public:
+    // main search, every legal move
+    MovePicker(const Chess& chess, Move ttMove, const Killers& killers, const HistoryTable& history);
+    // quiescence, captures and promotions that don't lose material
+    MovePicker(const Chess& chess, Move ttMove, const HistoryTable& history);
+
+    // kNullMove once all moves have been returned
+    Move Next(void);
+    Stage GetStage(void) const { return stage; }
+
+  private:
+    void ScoreCaptures(void);
+    void ScoreQuiets(void);
+    bool IsGoodCapture(Move move) const;
+    bool IsSpecial(Move move) const;
+    Move PickBest(void);
+
+  private:
+    const Chess& chess;
+    const HistoryTable& history;
+    Move ttMove;
+    Killers killers;
+    bool quiescence;
+    Stage stage;
+
+    MoveList moves;
+    int scores[kMaxMoves];
+    size_t current;
+
+    MoveList badCaptures;
+    size_t currentBad;
+    uint8_t currentKiller;
+};
+
+} // namespace chess
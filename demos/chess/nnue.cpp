@@ -0,0 +1,301 @@
+#include "nnue.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+#if defined(__AVX2__) || defined(__SSSE3__)
+#include <immintrin.h>
+#elif defined(__wasm_simd128__)
+#include <wasm_simd128.h>
+#endif
+
+namespace chess
+{
+
+namespace
+{
+
+constexpr int kInputs = 2 * kNetworkHidden;
+constexpr int kActivationMax = 127;
+constexpr int kLayer1Shift = 6;
+constexpr int kOutputDivisor = 16;
+
+// both perspectives see their own pieces as white, moving up the board
+constexpr int FeatureIndex(PieceColor perspective, Piece piece, uint8_t square)
+{
+    if (perspective == PieceColor::Black)
+    {
+        const auto color = GetPieceColor(piece) == PieceColor::White ? PieceColor::Black : PieceColor::White;
+        piece = MakePiece(color, GetPieceType(piece));
+        square ^= 56;
+    }
+    return GetPieceIndex(piece) * kNumSquares + square;
+}
+
+// int16 adds wrap the same way in both paths
+void AddWeights(int16_t* values, const int16_t* weights)
+{
+#if defined(__AVX2__)
+    for (auto i = 0; i < kNetworkHidden; i += 16)
+    {
+        const auto v = _mm256_load_si256(reinterpret_cast<const __m256i*>(values + i));
+        const auto w = _mm256_load_si256(reinterpret_cast<const __m256i*>(weights + i));
+        _mm256_store_si256(reinterpret_cast<__m256i*>(values + i), _mm256_add_epi16(v, w));
+    }
+#elif defined(__SSSE3__)
+    for (auto i = 0; i < kNetworkHidden; i += 8)
+    {
+        const auto v = _mm_load_si128(reinterpret_cast<const __m128i*>(values + i));
+        const auto w = _mm_load_si128(reinterpret_cast<const __m128i*>(weights + i));
+        _mm_store_si128(reinterpret_cast<__m128i*>(values + i), _mm_add_epi16(v, w));
+    }
+#elif defined(__wasm_simd128__)
+    for (auto i = 0; i < kNetworkHidden; i += 8)
+    {
+        const auto v = wasm_v128_load(values + i);
+        const auto w = wasm_v128_load(weights + i);
+        wasm_v128_store(values + i, wasm_i16x8_add(v, w));
+    }
+#else
+    for (auto i = 0; i < kNetworkHidden; ++i)
+    {
+        values[i] = static_cast<int16_t>(values[i] + weights[i]);
+    }
+#endif
+}
+
+void SubtractWeights(int16_t* values, const int16_t* weights)
+{
+#if defined(__AVX2__)
+    for (auto i = 0; i < kNetworkHidden; i += 16)
+    {
+        const auto v = _mm256_load_si256(reinterpret_cast<const __m256i*>(values + i));
+        const auto w = _mm256_load_si256(reinterpret_cast<const __m256i*>(weights + i));
+        _mm256_store_si256(reinterpret_cast<__m256i*>(values + i), _mm256_sub_epi16(v, w));
+    }
+#elif defined(__SSSE3__)
+    for (auto i = 0; i < kNetworkHidden; i += 8)
+    {
+        const auto v = _mm_load_si128(reinterpret_cast<const __m128i*>(values + i));
+        const auto w = _mm_load_si128(reinterpret_cast<const __m128i*>(weights + i));
+        _mm_store_si128(reinterpret_cast<__m128i*>(values + i), _mm_sub_epi16(v, w));
+    }
+#elif defined(__wasm_simd128__)
+    for (auto i = 0; i < kNetworkHidden; i += 8)
+    {
+        const auto v = wasm_v128_load(values + i);
+        const auto w = wasm_v128_load(weights + i);
+        wasm_v128_store(values + i, wasm_i16x8_sub(v, w));
+    }
+#else
+    for (auto i = 0; i < kNetworkHidden; ++i)
+    {
+        values[i] = static_cast<int16_t>(values[i] - weights[i]);
+    }
+#endif
+}
+
+// clipped relu, side to move first
+void Activate(const Accumulator& accumulator, PieceColor side, uint8_t* inputs)
+{
+    const auto& ours = accumulator.values[static_cast<uint8_t>(side)];
+    const auto& theirs = accumulator.values[static_cast<uint8_t>(side) ^ 1];
+    for (auto i = 0; i < kNetworkHidden; ++i)
+    {
+        inputs[i] = static_cast<uint8_t>(std::clamp<int>(ours[i], 0, kActivationMax));
+        inputs[kNetworkHidden + i] = static_cast<uint8_t>(std::clamp<int>(theirs[i], 0, kActivationMax));
+    }
+}
+
+// inputs are at most 127, so a pair of u8 * i8 products always fits the int16 of maddubs
+int32_t Dot(const uint8_t* inputs, const int8_t* weights)
+{
+#if defined(__AVX2__)
+    const auto ones = _mm256_set1_epi16(1);
+    auto sum = _mm256_setzero_si256();
+    for (auto i = 0; i < kInputs; i += 32)
+    {
+        const auto x = _mm256_load_si256(reinterpret_cast<const __m256i*>(inputs + i));
+        const auto w = _mm256_load_si256(reinterpret_cast<const __m256i*>(weights + i));
+        sum = _mm256_add_epi32(sum, _mm256_madd_epi16(_mm256_maddubs_epi16(x, w), ones));
+    }
+    auto half = _mm_add_epi32(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+    half = _mm_add_epi32(half, _mm_shuffle_epi32(half, 0x4E));
+    half = _mm_add_epi32(half, _mm_shuffle_epi32(half, 0xB1));
+    return _mm_cvtsi128_si32(half);
+#elif defined(__SSSE3__)
+    const auto ones = _mm_set1_epi16(1);
+    auto sum = _mm_setzero_si128();
+    for (auto i = 0; i < kInputs; i += 16)
+    {
+        const auto x = _mm_load_si128(reinterpret_cast<const __m128i*>(inputs + i));
+        const auto w = _mm_load_si128(reinterpret_cast<const __m128i*>(weights + i));
+        sum = _mm_add_epi32(sum, _mm_madd_epi16(_mm_maddubs_epi16(x, w), ones));
+    }
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0x4E));
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0xB1));
+    return _mm_cvtsi128_si32(sum);
+#elif defined(__wasm_simd128__)
+    auto sum = wasm_i32x4_splat(0);
+    for (auto i = 0; i < kInputs; i += 16)
+    {
+        const auto x = wasm_v128_load(inputs + i);
+        const auto w = wasm_v128_load(weights + i);
+        sum = wasm_i32x4_add(sum, wasm_i32x4_dot_i16x8(wasm_u16x8_extend_low_u8x16(x), wasm_i16x8_extend_low_i8x16(w)));
+        sum = wasm_i32x4_add(sum, wasm_i32x4_dot_i16x8(wasm_u16x8_extend_high_u8x16(x), wasm_i16x8_extend_high_i8x16(w)));
+    }
+    return wasm_i32x4_extract_lane(sum, 0) + wasm_i32x4_extract_lane(sum, 1) +
+           wasm_i32x4_extract_lane(sum, 2) + wasm_i32x4_extract_lane(sum, 3);
+#else
+    int32_t sum = 0;
+    for (auto i = 0; i < kInputs; ++i)
+    {
+        sum += inputs[i] * weights[i];
+    }
+    return sum;
+#endif
+}
+
+int32_t DotScalar(const uint8_t* inputs, const int8_t* weights)
+{
+    int32_t sum = 0;
+    for (auto i = 0; i < kInputs; ++i)
+    {
+        sum += inputs[i] * weights[i];
+    }
+    return sum;
+}
+
+// reads little endian values off the front of the buffer
+class Reader
+{
+  public:
+    Reader(const uint8_t* data, size_t size) : data(data), size(size) {}
+
+    template <typename T>
+    bool Read(T* values, size_t count)
+    {
+        const auto bytes = count * sizeof(T);
+        if (bytes > size)
+        {
+            return false;
+        }
+        std::memcpy(values, data, bytes);
+        data += bytes;
+        size -= bytes;
+        return true;
+    }
+
+  private:
+    const uint8_t* data;
+    size_t size;
+};
+
+} // namespace
+
+void Accumulator::Reset(const Network& network)
+{
+    values[0] = network.featureBiases;
+    values[1] = network.featureBiases;
+}
+
+void Accumulator::Add(const Network& network, Piece piece, uint8_t square)
+{
+    for (const auto perspective : {PieceColor::White, PieceColor::Black})
+    {
+        const auto& weights = network.featureWeights[FeatureIndex(perspective, piece, square)];
+        AddWeights(values[static_cast<uint8_t>(perspective)].data(), weights.data());
+    }
+}
+
+void Accumulator::Remove(const Network& network, Piece piece, uint8_t square)
+{
+    for (const auto perspective : {PieceColor::White, PieceColor::Black})
+    {
+        const auto& weights = network.featureWeights[FeatureIndex(perspective, piece, square)];
+        SubtractWeights(values[static_cast<uint8_t>(perspective)].data(), weights.data());
+    }
+}
+
+Network::Network() : featureBiases{}, featureWeights{}, layer1Biases{}, layer1Weights{}, outputBias(0), outputWeights{}
+{
+}
+
+bool Network::Load(const uint8_t* data, size_t size)
+{
+    if (size != kNetworkFileSize)
+    {
+        return false;
+    }
+
+    Reader reader(data, size);
+
+    uint32_t header[4] = {};
+    reader.Read(header, 4);
+    if (header[0] != kNetworkMagic || header[1] != kNetworkVersion ||
+        header[2] != kNetworkHidden || header[3] != kNetworkLayer1)
+    {
+        return false;
+    }
+
+    // the size check above guarantees every read succeeds
+    reader.Read(featureBiases.data(), featureBiases.size());
+    for (auto& weights : featureWeights)
+    {
+        reader.Read(weights.data(), weights.size());
+    }
+    reader.Read(layer1Biases.data(), layer1Biases.size());
+    for (auto& weights : layer1Weights)
+    {
+        reader.Read(weights.data(), weights.size());
+    }
+    reader.Read(&outputBias, 1);
+    reader.Read(outputWeights.data(), outputWeights.size());
+
+    return true;
+}
+
+bool Network::LoadFile(const std::string& path)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file)
+    {
+        return false;
+    }
+
+    const std::vector<uint8_t> bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    return Load(bytes.data(), bytes.size());
+}
+
+int Network::Evaluate(const Accumulator& accumulator, PieceColor side) const
+{
+    alignas(64) uint8_t inputs[kInputs];
+    Activate(accumulator, side, inputs);
+
+    int32_t output = outputBias;
+    for (auto i = 0; i < kNetworkLayer1; ++i)
+    {
+        const auto hidden = (Dot(inputs, layer1Weights[i].data()) + layer1Biases[i]) >> kLayer1Shift;
+        output += std::clamp(hidden, 0, kActivationMax) * outputWeights[i];
+    }
+    return output / kOutputDivisor;
+}
+
+int Network::EvaluateScalar(const Accumulator& accumulator, PieceColor side) const
+{
+    alignas(64) uint8_t inputs[kInputs];
+    Activate(accumulator, side, inputs);
+
+    int32_t output = outputBias;
+    for (auto i = 0; i < kNetworkLayer1; ++i)
+    {
+        const auto hidden = (DotScalar(inputs, layer1Weights[i].data()) + layer1Biases[i]) >> kLayer1Shift;
+        output += std::clamp(hidden, 0, kActivationMax) * outputWeights[i];
+    }
+    return output / kOutputDivisor;
+}
+
+} // namespace chess
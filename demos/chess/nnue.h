@@ -0,0 +1,67 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "piece.h"
+
+namespace chess
+{
+
+// 768 piece-square inputs per perspective -> 2x128 accumulator -> 32 -> 1
+constexpr const int kNetworkFeatures = kNumPieces * kNumSquares;
+constexpr const int kNetworkHidden = 128;
+constexpr const int kNetworkLayer1 = 32;
+
+constexpr const uint32_t kNetworkMagic = 0x45554E43; // "CNUE"
+constexpr const uint32_t kNetworkVersion = 1;
+
+// header, feature transformer, layer 1 and output layer, all little endian
+constexpr const size_t kNetworkFileSize = 4 * sizeof(uint32_t) +
+                                          kNetworkHidden * sizeof(int16_t) +
+                                          kNetworkFeatures * kNetworkHidden * sizeof(int16_t) +
+                                          kNetworkLayer1 * sizeof(int32_t) +
+                                          kNetworkLayer1 * 2 * kNetworkHidden * sizeof(int8_t) +
+                                          sizeof(int32_t) +
+                                          kNetworkLayer1 * sizeof(int8_t);
+
+class Network;
+
+// first layer outputs for both perspectives, indexed by PieceColor
+struct alignas(64) Accumulator
+{
+    std::array<std::array<int16_t, kNetworkHidden>, kNumColors> values;
+
+    void Reset(const Network& network);
+    void Add(const Network& network, Piece piece, uint8_t square);
+    void Remove(const Network& network, Piece piece, uint8_t square);
+};
+
+// Quantized network. The SIMD and scalar paths only use exact integer
+// arithmetic and produce the same score for every input.
+class Network
+{
+  public:
+    Network();
+
+    bool Load(const uint8_t* data, size_t size);
+    bool LoadFile(const std::string& path);
+
+    // centipawns from the side's point of view
+    int Evaluate(const Accumulator& accumulator, PieceColor side) const;
+    int EvaluateScalar(const Accumulator& accumulator, PieceColor side) const;
+
+  private:
+    friend struct Accumulator;
+
+    alignas(64) std::array<int16_t, kNetworkHidden> featureBiases;
+    alignas(64) std::array<std::array<int16_t, kNetworkHidden>, kNetworkFeatures> featureWeights;
+    alignas(64) std::array<int32_t, kNetworkLayer1> layer1Biases;
+    alignas(64) std::array<std::array<int8_t, 2 * kNetworkHidden>, kNetworkLayer1> layer1Weights;
+    int32_t outputBias;
+    alignas(64) std::array<int8_t, kNetworkLayer1> outputWeights;
+};
+
+} // namespace chess
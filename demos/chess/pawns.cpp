@@ -0,0 +1,119 @@
+#include "pawns.h"
+#include "bitboard.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+
+namespace chess
+{
+
+namespace
+{
+
+// indexed by how far the pawn has advanced, 1 on its starting rank
+constexpr std::array<int, kNumRanks> kPassedMidgame = {0, 5, 10, 15, 25, 40, 60, 0};
+constexpr std::array<int, kNumRanks> kPassedEndgame = {0, 10, 15, 25, 45, 75, 120, 0};
+
+constexpr int kDoubledMidgame = -10;
+constexpr int kDoubledEndgame = -20;
+constexpr int kIsolatedMidgame = -10;
+constexpr int kIsolatedEndgame = -15;
+
+} // namespace
+
+PawnTable::PawnTable(size_t megabytes)
+{
+    Resize(megabytes);
+}
+
+void PawnTable::Resize(size_t megabytes)
+{
+    const auto bytes = std::max<size_t>(megabytes, 1) * 1024 * 1024;
+    const auto count = std::bit_floor(bytes / sizeof(PawnEntry));
+
+    entries = std::vector<PawnEntry>(count);
+    mask = count - 1;
+    Clear();
+}
+
+void PawnTable::Clear(void)
+{
+    // every key bit set marks an empty entry, zero is the key of a board without pawns
+    std::fill(entries.begin(), entries.end(), PawnEntry{.key = ~0ULL});
+    hits = 0;
+    misses = 0;
+}
+
+const PawnEntry& PawnTable::Probe(const Chess& chess)
+{
+    const auto key = chess.GetPawnHash();
+    auto& entry = entries[key & mask];
+    if (entry.key == key)
+    {
+        ++hits;
+        return entry;
+    }
+
+    ++misses;
+    entry = EvaluatePawns(chess);
+    entry.key = key;
+    return entry;
+}
+
+const PawnEntry EvaluatePawns(const Chess& chess)
+{
+    PawnEntry entry = {};
+
+    for (const auto color : {PieceColor::White, PieceColor::Black})
+    {
+        const auto white = color == PieceColor::White;
+        const auto ours = chess.GetPieces(color, PieceType::Pawn);
+        const auto theirs = chess.GetPieces(white ? PieceColor::Black : PieceColor::White, PieceType::Pawn);
+        const auto& passedMasks = white ? WhitePassedPawnMasks : BlackPassedPawnMasks;
+
+        auto midgame = 0;
+        auto endgame = 0;
+
+        for (auto file = 0; file < kNumFiles; ++file)
+        {
+            const auto count = CountPieces(ours & FileMasks[file]);
+            if (count > 1)
+            {
+                midgame += (count - 1) * kDoubledMidgame;
+                endgame += (count - 1) * kDoubledEndgame;
+            }
+        }
+
+        Bitboard pawns = ours;
+        while (pawns)
+        {
+            const auto square = MoveFromBitboard(pawns);
+            pawns &= pawns - 1;
+
+            if ((ours & AdjacentFilesMasks[square]) == kEmptyBitboard)
+            {
+                midgame += kIsolatedMidgame;
+                endgame += kIsolatedEndgame;
+            }
+
+            // a pawn behind a friendly one on the same file isn't counted as passed
+            if ((theirs & passedMasks[square]) == kEmptyBitboard &&
+                (ours & passedMasks[square] & FileMasks[square % kNumFiles]) == kEmptyBitboard)
+            {
+                const auto rank = square / kNumFiles;
+                const auto advanced = white ? (kNumRanks - 1 - rank) : rank;
+                midgame += kPassedMidgame[advanced];
+                endgame += kPassedEndgame[advanced];
+                entry.passed |= MaskFromSquare(square);
+            }
+        }
+
+        entry.midgame += static_cast<int16_t>(white ? midgame : -midgame);
+        entry.endgame += static_cast<int16_t>(white ? endgame : -endgame);
+    }
+
+    return entry;
+}
+
+} // namespace chess
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "chess.h"
+
+namespace chess
+{
+
+constexpr const size_t kDefaultPawnTableSize = 1; // megabytes
+
+// pawn structure terms from white's point of view
+struct PawnEntry
+{
+    uint64_t key;
+    int16_t midgame;
+    int16_t endgame;
+    Bitboard passed; // passed pawns of both colors
+};
+
+// Per thread cache of pawn structure scores keyed by Chess::GetPawnHash,
+// the pawns change far less often than the rest of the position.
+class PawnTable
+{
+  public:
+    explicit PawnTable(size_t megabytes = kDefaultPawnTableSize);
+
+    void Resize(size_t megabytes);
+    void Clear(void);
+
+    const PawnEntry& Probe(const Chess& chess);
+
+    uint64_t GetHits(void) const { return hits; }
+    uint64_t GetMisses(void) const { return misses; }
+
+  private:
+    std::vector<PawnEntry> entries;
+    uint64_t mask;
+    uint64_t hits;
+    uint64_t misses;
+};
+
+// evaluates the pawn structure from scratch
+const PawnEntry EvaluatePawns(const Chess& chess);
+
+} // namespace chess
@@ -0,0 +1,164 @@
+#include "perft.h"
+
+#include <algorithm>
+#include <bit>
+#include <thread>
+
+namespace chess
+{
+
+namespace
+{
+
+// the same position at another depth has another count
+constexpr uint64_t PerftKey(uint64_t hash, int depth)
+{
+    return hash ^ (static_cast<uint64_t>(depth) * 0x9E3779B97F4A7C15ULL);
+}
+
+uint64_t CountNodes(Chess& chess, int depth, PerftTable* table)
+{
+    return table ? Perft(chess, depth, *table) : Perft(chess, depth);
+}
+
+} // namespace
+
+PerftTable::PerftTable(size_t megabytes)
+{
+    // round down to a power of two so the index is a mask
+    const auto bytes = std::max<size_t>(megabytes, 1) * 1024 * 1024;
+    const auto count = std::bit_floor(bytes / sizeof(Slot));
+
+    slots = std::vector<Slot>(count);
+    mask = count - 1;
+    for (auto& slot : slots)
+    {
+        slot.key.store(0, std::memory_order_relaxed);
+        slot.nodes.store(0, std::memory_order_relaxed);
+    }
+}
+
+bool PerftTable::Probe(uint64_t hash, int depth, uint64_t& nodes) const
+{
+    const auto key = PerftKey(hash, depth);
+    const auto& slot = slots[key & mask];
+    const auto stored = slot.nodes.load(std::memory_order_relaxed);
+    if ((slot.key.load(std::memory_order_relaxed) ^ stored) == key && stored != 0)
+    {
+        nodes = stored;
+        return true;
+    }
+    return false;
+}
+
+void PerftTable::Store(uint64_t hash, int depth, uint64_t nodes)
+{
+    const auto key = PerftKey(hash, depth);
+    auto& slot = slots[key & mask];
+    slot.key.store(key ^ nodes, std::memory_order_relaxed);
+    slot.nodes.store(nodes, std::memory_order_relaxed);
+}
+
+uint64_t Perft(Chess& chess, int depth)
+{
+    if (depth <= 0)
+    {
+        return 1;
+    }
+
+    MoveList moves;
+    chess.Moves(moves);
+    if (depth == 1)
+    {
+        return moves.size();
+    }
+
+    uint64_t nodes = 0;
+    for (const auto& move : moves)
+    {
+        chess.MakeMove(move);
+        nodes += Perft(chess, depth - 1);
+        chess.UnmakeMove();
+    }
+    return nodes;
+}
+
+uint64_t Perft(Chess& chess, int depth, PerftTable& table)
+{
+    // the last ply only counts moves, looking it up would cost more
+    if (depth <= 1)
+    {
+        return Perft(chess, depth);
+    }
+
+    uint64_t nodes = 0;
+    if (table.Probe(chess.GetHash(), depth, nodes))
+    {
+        return nodes;
+    }
+
+    MoveList moves;
+    chess.Moves(moves);
+    for (const auto& move : moves)
+    {
+        chess.MakeMove(move);
+        nodes += Perft(chess, depth - 1, table);
+        chess.UnmakeMove();
+    }
+
+    table.Store(chess.GetHash(), depth, nodes);
+    return nodes;
+}
+
+const std::vector<PerftDivide> Divide(Chess& chess, int depth, PerftTable* table, int threads)
+{
+    std::vector<PerftDivide> result = {};
+    if (depth <= 0)
+    {
+        return result;
+    }
+
+    MoveList moves;
+    chess.Moves(moves);
+    for (const auto& move : moves)
+    {
+        result.push_back(PerftDivide{
+            .move = move,
+            .nodes = 0,
+        });
+    }
+
+    // every thread plays on its own copy and takes the next root move when it is done
+    std::atomic<size_t> next = 0;
+    const auto work = [&](Chess& position)
+    {
+        for (auto i = next.fetch_add(1); i < result.size(); i = next.fetch_add(1))
+        {
+            position.MakeMove(result[i].move);
+            result[i].nodes = CountNodes(position, depth - 1, table);
+            position.UnmakeMove();
+        }
+    };
+
+    const auto numThreads = kThreadsAvailable ? std::max(1, std::min(threads, static_cast<int>(result.size()))) : 1;
+    if (numThreads <= 1)
+    {
+        work(chess);
+        return result;
+    }
+
+    std::vector<std::thread> workers;
+    std::vector<Chess> positions(numThreads, chess);
+    for (auto i = 0; i < numThreads; ++i)
+    {
+        workers.emplace_back([&, i]()
+                             { work(positions[i]); });
+    }
+    for (auto& worker : workers)
+    {
+        worker.join();
+    }
+    return result;
+}
+
+} // namespace chess
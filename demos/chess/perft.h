@@ -0,0 +1,49 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "chess.h"
+
+namespace chess
+{
+
+constexpr const size_t kDefaultPerftTableSize = 64; // megabytes
+
+struct PerftDivide
+{
+    Move move;
+    uint64_t nodes;
+};
+
+// Subtree counts keyed by position and depth, shared by every perft thread. Each
+// slot keeps (key ^ nodes, nodes) like the transposition table, so a torn write
+// fails verification instead of returning another subtree's count.
+class PerftTable
+{
+  public:
+    explicit PerftTable(size_t megabytes = kDefaultPerftTableSize);
+
+    bool Probe(uint64_t hash, int depth, uint64_t& nodes) const;
+    void Store(uint64_t hash, int depth, uint64_t nodes);
+
+  private:
+    struct Slot
+    {
+        std::atomic<uint64_t> key;
+        std::atomic<uint64_t> nodes;
+    };
+
+    std::vector<Slot> slots;
+    uint64_t mask;
+};
+
+uint64_t Perft(Chess& chess, int depth);
+uint64_t Perft(Chess& chess, int depth, PerftTable& table);
+
+// the root moves are shared out over the threads, the table is optional
+const std::vector<PerftDivide> Divide(Chess& chess, int depth, PerftTable* table = nullptr, int threads = 1);
+
+} // namespace chess
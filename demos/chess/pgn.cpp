@@ -0,0 +1,305 @@
+#include "pgn.h"
+#include "san.h"
+
+#include <cstring>
+
+namespace chess
+{
+
+namespace
+{
+
+constexpr bool IsSpace(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+constexpr bool IsDigit(char c)
+{
+    return c >= '0' && c <= '9';
+}
+
+// characters that end a movetext token without being part of it
+constexpr bool IsDelimiter(char c)
+{
+    return IsSpace(c) || c == '{' || c == '}' || c == '(' || c == ')' || c == ';' || c == '[';
+}
+
+constexpr bool IsResult(std::string_view token)
+{
+    return token == "1-0" || token == "0-1" || token == "1/2-1/2" || token == "*";
+}
+
+} // namespace
+
+PgnReader::PgnReader(PgnVisitor& visitor)
+    : visitor(visitor), state(State::Text), lineStart(true), inGame(false), inMovetext(false), variationDepth(0),
+      status(PgnStatus::Ok), plies(0), games(0), tokenLength(0), tagNameLength(0), tagValueLength(0)
+{
+}
+
+void PgnReader::Feed(const char* data, size_t size)
+{
+    const auto* end = data + size;
+    for (const auto* p = data; p < end; ++p)
+    {
+        const auto c = *p;
+        switch (state)
+        {
+        case State::Text:
+            Text(c);
+            break;
+        case State::Token:
+            if (IsDelimiter(c))
+            {
+                EndToken();
+                Text(c);
+            }
+            else if (tokenLength++ < token.size())
+            {
+                token[tokenLength - 1] = c;
+            }
+            break;
+        case State::Comment:
+        {
+            // comments are most of an annotated file, so jump straight to the end
+            const auto* close = static_cast<const char*>(std::memchr(p, '}', end - p));
+            p = close ? close : end - 1;
+            state = close ? State::Text : State::Comment;
+            break;
+        }
+        case State::LineComment:
+        {
+            const auto* newline = static_cast<const char*>(std::memchr(p, '\n', end - p));
+            p = newline ? newline : end - 1;
+            state = newline ? State::Text : State::LineComment;
+            break;
+        }
+        case State::TagName:
+            if (c == '"')
+            {
+                state = State::TagValue;
+            }
+            else if (IsSpace(c))
+            {
+                state = State::TagSpace;
+            }
+            else if (c == ']')
+            {
+                state = State::Text;
+            }
+            else if (tagNameLength < tagName.size())
+            {
+                tagName[tagNameLength++] = c;
+            }
+            break;
+        case State::TagSpace:
+            if (c == '"')
+            {
+                state = State::TagValue;
+            }
+            else if (c == ']')
+            {
+                state = State::Text;
+            }
+            break;
+        case State::TagValue:
+            if (c == '"')
+            {
+                EndTag();
+                state = State::TagEnd;
+            }
+            else if (c == '\\')
+            {
+                state = State::TagEscape;
+            }
+            else if (tagValueLength < tagValue.size())
+            {
+                tagValue[tagValueLength++] = c;
+            }
+            break;
+        case State::TagEscape:
+            if (tagValueLength < tagValue.size())
+            {
+                tagValue[tagValueLength++] = c;
+            }
+            state = State::TagValue;
+            break;
+        case State::TagEnd:
+            if (c == ']')
+            {
+                state = State::Text;
+            }
+            break;
+        }
+        lineStart = (*p == '\n');
+    }
+}
+
+void PgnReader::Finish(void)
+{
+    if (state == State::Token)
+    {
+        EndToken();
+    }
+    if (inGame)
+    {
+        EndGame("*");
+    }
+    state = State::Text;
+    lineStart = true;
+}
+
+void PgnReader::Text(char c)
+{
+    switch (c)
+    {
+    case ' ':
+    case '\t':
+    case '\r':
+    case '\n':
+    case '}':
+        break;
+    case '{':
+        state = State::Comment;
+        break;
+    case ';':
+        state = State::LineComment;
+        break;
+    case '(':
+        ++variationDepth;
+        break;
+    case ')':
+        variationDepth -= variationDepth > 0 ? 1 : 0;
+        break;
+    case '[':
+        // tags after movetext belong to the next game, this one never got its result
+        if (inGame && inMovetext)
+        {
+            EndGame("*");
+        }
+        tagNameLength = 0;
+        tagValueLength = 0;
+        state = State::TagName;
+        break;
+    case '%':
+        // escaped lines are for other programs
+        if (lineStart)
+        {
+            state = State::LineComment;
+            break;
+        }
+        [[fallthrough]];
+    default:
+        // stray bytes like a UTF-8 byte order mark can't start a move
+        if (static_cast<unsigned char>(c) >= 0x80)
+        {
+            break;
+        }
+        token[0] = c;
+        tokenLength = 1;
+        state = State::Token;
+        break;
+    }
+}
+
+void PgnReader::EndToken(void)
+{
+    state = State::Text;
+    if (variationDepth > 0)
+    {
+        return;
+    }
+
+    const auto overflow = tokenLength > token.size();
+    auto text = std::string_view(token.data(), overflow ? token.size() : tokenLength);
+
+    if (!inGame)
+    {
+        StartGame();
+    }
+    inMovetext = true;
+
+    if (IsResult(text))
+    {
+        EndGame(text);
+        return;
+    }
+    if (text.front() == '$')
+    {
+        return;
+    }
+
+    // move numbers, also when they are glued to the move as in "12.e4" or "12...Nf6"
+    size_t digits = 0;
+    while (digits < text.size() && IsDigit(text[digits]))
+    {
+        ++digits;
+    }
+    if (digits < text.size() && text[digits] == '.')
+    {
+        text.remove_prefix(digits);
+    }
+    while (!text.empty() && text.front() == '.')
+    {
+        text.remove_prefix(1);
+    }
+    if (text.empty() || status != PgnStatus::Ok)
+    {
+        return;
+    }
+
+    if (plies >= kMaxGamePly)
+    {
+        status = PgnStatus::TooLong;
+        return;
+    }
+
+    const auto move = overflow ? kNullMove : ParseSAN(chess, text);
+    if (move == kNullMove)
+    {
+        status = PgnStatus::IllegalMove;
+        return;
+    }
+
+    visitor.OnMove(chess, move);
+    chess.MakeMove(move);
+    ++plies;
+}
+
+void PgnReader::EndTag(void)
+{
+    if (!inGame)
+    {
+        StartGame();
+    }
+
+    const auto name = std::string_view(tagName.data(), tagNameLength);
+    const auto value = std::string_view(tagValue.data(), tagValueLength);
+    if (name == "FEN" && chess.Load(value) != FenError::None)
+    {
+        status = PgnStatus::InvalidFen;
+    }
+    visitor.OnTag(name, value);
+}
+
+void PgnReader::StartGame(void)
+{
+    chess.Reset();
+    inGame = true;
+    inMovetext = false;
+    variationDepth = 0;
+    status = PgnStatus::Ok;
+    plies = 0;
+    visitor.OnGameStart();
+}
+
+void PgnReader::EndGame(std::string_view result)
+{
+    visitor.OnGameEnd(chess, result, status);
+    inGame = false;
+    inMovetext = false;
+    ++games;
+}
+
+} // namespace chess
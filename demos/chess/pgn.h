@@ -0,0 +1,97 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+#include "chess.h"
+
+namespace chess
+{
+
+// longer movetext tokens are rejected, longer tag values are cut short
+constexpr const size_t kMaxPgnToken = 32;
+constexpr const size_t kMaxPgnTagName = 32;
+constexpr const size_t kMaxPgnTagValue = 256;
+
+enum class PgnStatus : uint8_t
+{
+    Ok = 0,
+    InvalidFen,  // the FEN tag didn't load, the game starts from nowhere
+    IllegalMove, // a move didn't decode, the rest of the game is skipped
+    TooLong,     // more than kMaxGamePly plies
+};
+
+// Receives the games as they are read. Every string_view points into the
+// reader and is only valid during the call.
+class PgnVisitor
+{
+  public:
+    virtual ~PgnVisitor() = default;
+
+    virtual void OnGameStart(void) {}
+    virtual void OnTag(std::string_view name, std::string_view value) {}
+    // the position before the move is played
+    virtual void OnMove(const Chess& chess, Move move) {}
+    // result is "1-0", "0-1", "1/2-1/2" or "*", which also stands in for a missing one
+    virtual void OnGameEnd(const Chess& chess, std::string_view result, PgnStatus status) {}
+};
+
+// Push parser for PGN game collections. Input can be split anywhere, so a
+// mapped file can be fed at once and a download chunk by chunk, and memory
+// stays the same however large the collection is. Moves are decoded with
+// ParseSAN and played on the reader's board, comments, NAGs and variations
+// are skipped.
+class PgnReader
+{
+  public:
+    explicit PgnReader(PgnVisitor& visitor);
+
+    void Feed(const char* data, size_t size);
+    // ends the last game when the input stops without a result
+    void Finish(void);
+
+    uint64_t GetGames(void) const { return games; }
+
+  private:
+    enum class State : uint8_t
+    {
+        Text,
+        Token,
+        Comment,
+        LineComment,
+        TagName,
+        TagSpace,
+        TagValue,
+        TagEscape,
+        TagEnd,
+    };
+
+    void Text(char c);
+    void EndToken(void);
+    void EndTag(void);
+    void StartGame(void);
+    void EndGame(std::string_view result);
+
+    PgnVisitor& visitor;
+    Chess chess;
+
+    State state;
+    bool lineStart;
+    bool inGame;
+    bool inMovetext;
+    int variationDepth;
+    PgnStatus status;
+    uint16_t plies;
+    uint64_t games;
+
+    std::array<char, kMaxPgnToken> token;
+    size_t tokenLength;
+    std::array<char, kMaxPgnTagName> tagName;
+    size_t tagNameLength;
+    std::array<char, kMaxPgnTagValue> tagValue;
+    size_t tagValueLength;
+};
+
+} // namespace chess
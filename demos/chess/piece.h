@@ -1,5 +1,7 @@
 #pragma once
 
+#include <array>
+
 #include "consts.h"
 
 namespace chess
@@ -87,6 +89,15 @@ constexpr PieceType GetPieceType(const Piece piece)
     return static_cast<PieceType>(static_cast<uint8_t>(piece) & kPieceTypeMask);
 }
 
+// dense 0-11 index, white pawn..king then black pawn..king
+constexpr uint8_t GetPieceIndex(const Piece piece)
+{
+    return static_cast<uint8_t>(GetPieceColor(piece)) * kNumPieceTypes + static_cast<uint8_t>(GetPieceType(piece)) - 1;
+}
+
+// centipawn values indexed by PieceType, shared by move ordering and exchange evaluation
+constexpr const std::array<int, 7> kPieceValues = {0, 100, 320, 330, 500, 900, 0};
+
 // white pieces
 constexpr const Piece WhitePawn = MakePiece(PieceColor::White, PieceType::Pawn);
 constexpr const Piece WhiteKnight = MakePiece(PieceColor::White, PieceType::Knight);
@@ -0,0 +1,238 @@
+#include "san.h"
+
+namespace chess
+{
+
+namespace
+{
+
+constexpr PieceType PieceTypeFromSAN(char c)
+{
+    switch (c)
+    {
+    case 'N':
+        return PieceType::Knight;
+    case 'B':
+        return PieceType::Bishop;
+    case 'R':
+        return PieceType::Rook;
+    case 'Q':
+        return PieceType::Queen;
+    case 'K':
+        return PieceType::King;
+    default:
+        return PieceType::None;
+    }
+}
+
+constexpr char SANFromPieceType(PieceType type)
+{
+    constexpr const char kChars[] = "  NBRQK";
+    return kChars[static_cast<uint8_t>(type)];
+}
+
+constexpr bool IsFile(char c)
+{
+    return c >= 'a' && c <= 'h';
+}
+
+constexpr bool IsRank(char c)
+{
+    return c >= '1' && c <= '8';
+}
+
+constexpr int FileOf(uint8_t square)
+{
+    return square % kNumFiles;
+}
+
+constexpr int RankOf(uint8_t square)
+{
+    return square / kNumFiles;
+}
+
+Move FindCastling(const Chess& chess, MoveFlag flag)
+{
+    MoveList moves;
+    chess.MovesForPiece(MakePiece(chess.GetTurn(), PieceType::King), moves);
+    for (const auto& move : moves)
+    {
+        if (move.Flag() == flag)
+        {
+            return move;
+        }
+    }
+    return kNullMove;
+}
+
+} // namespace
+
+Move ParseSAN(const Chess& chess, std::string_view san)
+{
+    while (!san.empty() && (san.back() == '+' || san.back() == '#' || san.back() == '!' || san.back() == '?'))
+    {
+        san.remove_suffix(1);
+    }
+
+    if (san == "O-O" || san == "0-0")
+    {
+        return FindCastling(chess, MoveFlag::KingCastle);
+    }
+    if (san == "O-O-O" || san == "0-0-0")
+    {
+        return FindCastling(chess, MoveFlag::QueenCastle);
+    }
+
+    auto type = PieceType::Pawn;
+    if (!san.empty() && PieceTypeFromSAN(san.front()) != PieceType::None)
+    {
+        type = PieceTypeFromSAN(san.front());
+        san.remove_prefix(1);
+    }
+
+    // e8=Q, some writers leave out the '='
+    auto promotion = PieceType::None;
+    if (type == PieceType::Pawn && !san.empty() && PieceTypeFromSAN(san.back()) != PieceType::None)
+    {
+        promotion = PieceTypeFromSAN(san.back());
+        san.remove_suffix(1);
+        if (!san.empty() && san.back() == '=')
+        {
+            san.remove_suffix(1);
+        }
+    }
+
+    if (san.size() < 2 || !IsFile(san[san.size() - 2]) || !IsRank(san.back()))
+    {
+        return kNullMove;
+    }
+    const auto to = static_cast<uint8_t>((kNumRanks - (san.back() - '0')) * kNumFiles + (san[san.size() - 2] - 'a'));
+    san.remove_suffix(2);
+
+    // what is left is the disambiguation, with capture and long algebraic marks in between
+    auto file = -1;
+    auto rank = -1;
+    for (const auto c : san)
+    {
+        if (IsFile(c))
+        {
+            file = c - 'a';
+        }
+        else if (IsRank(c))
+        {
+            rank = kNumRanks - (c - '0');
+        }
+        else if (c != 'x' && c != ':' && c != '-')
+        {
+            return kNullMove;
+        }
+    }
+
+    // a pawn without a file pushes, so "e4" never means dxe4
+    if (type == PieceType::Pawn && file < 0)
+    {
+        file = FileOf(to);
+    }
+
+    MoveList moves;
+    chess.MovesForPiece(MakePiece(chess.GetTurn(), type), moves);
+
+    auto found = kNullMove;
+    for (const auto& move : moves)
+    {
+        if (move.To() != to || move.Promotion() != promotion || move.IsCastling() ||
+            (file >= 0 && FileOf(move.From()) != file) || (rank >= 0 && RankOf(move.From()) != rank))
+        {
+            continue;
+        }
+        if (found != kNullMove)
+        {
+            return kNullMove;
+        }
+        found = move;
+    }
+    return found;
+}
+
+size_t WriteSAN(Chess& chess, Move move, char* out)
+{
+    auto* p = out;
+    const auto from = move.From();
+    const auto to = move.To();
+    const auto type = GetPieceType(chess.GetPiece(from));
+
+    if (move.IsCastling())
+    {
+        const auto* castle = move.Flag() == MoveFlag::KingCastle ? "O-O" : "O-O-O";
+        while (*castle)
+        {
+            *p++ = *castle++;
+        }
+    }
+    else if (type == PieceType::Pawn)
+    {
+        if (move.IsCapture())
+        {
+            *p++ = kSANPositions[from][0];
+            *p++ = 'x';
+        }
+        *p++ = kSANPositions[to][0];
+        *p++ = kSANPositions[to][1];
+        if (move.IsPromotion())
+        {
+            *p++ = '=';
+            *p++ = SANFromPieceType(move.Promotion());
+        }
+    }
+    else
+    {
+        *p++ = SANFromPieceType(type);
+
+        // only name the file or rank when another piece of the same kind could go there too
+        MoveList moves;
+        chess.MovesForPiece(chess.GetPiece(from), moves);
+        auto ambiguous = false;
+        auto sameFile = false;
+        auto sameRank = false;
+        for (const auto& other : moves)
+        {
+            if (other.To() == to && other.From() != from)
+            {
+                ambiguous = true;
+                sameFile |= FileOf(other.From()) == FileOf(from);
+                sameRank |= RankOf(other.From()) == RankOf(from);
+            }
+        }
+        if (ambiguous && (!sameFile || sameRank))
+        {
+            *p++ = kSANPositions[from][0];
+        }
+        if (ambiguous && sameFile)
+        {
+            *p++ = kSANPositions[from][1];
+        }
+
+        if (move.IsCapture())
+        {
+            *p++ = 'x';
+        }
+        *p++ = kSANPositions[to][0];
+        *p++ = kSANPositions[to][1];
+    }
+
+    chess.MakeMove(move);
+    if (chess.InCheckmate())
+    {
+        *p++ = '#';
+    }
+    else if (chess.InCheck(chess.GetTurn()))
+    {
+        *p++ = '+';
+    }
+    chess.UnmakeMove();
+
+    *p = '\0';
+    return static_cast<size_t>(p - out);
+}
+
+} // namespace chess
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <cstddef>
+#include <string_view>
+
+#include "chess.h"
+
+namespace chess
+{
+
+// "Qh4xe1+", "exd8=Q#" and "O-O-O+" all fit with the terminator
+constexpr const size_t kMaxSanLength = 8;
+
+// Decodes a SAN move against the legal moves of the position, kNullMove when
+// it is illegal or ambiguous. Check marks and annotations like "!?" are ignored,
+// and so are missing or extra capture marks.
+Move ParseSAN(const Chess& chess, std::string_view san);
+
+// writes a null terminated SAN and returns its length, out must hold kMaxSanLength chars
+size_t WriteSAN(Chess& chess, Move move, char* out);
+
+} // namespace chess
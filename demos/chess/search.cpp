@@ -0,0 +1,423 @@
+#include "search.h"
+#include "tablebase.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace chess
+{
+
+namespace
+{
+
+constexpr int kAspirationWindow = 25;
+
+// mate scores are stored relative to the node, not the root
+constexpr int ScoreToTT(int score, int ply)
+{
+    if (score >= kMateBound)
+    {
+        return score + ply;
+    }
+    if (score <= -kMateBound)
+    {
+        return score - ply;
+    }
+    return score;
+}
+
+constexpr int ScoreFromTT(int score, int ply)
+{
+    if (score >= kMateBound)
+    {
+        return score - ply;
+    }
+    if (score <= -kMateBound)
+    {
+        return score + ply;
+    }
+    return score;
+}
+
+} // namespace
+
+Search::Search(TranspositionTable& table) : table(table), limits{}, stop(false), nodes(0), rootBest(kNullMove), killers{}, history{}, pawns()
+{
+}
+
+const SearchResult Search::Run(const Chess& position, const SearchLimits& searchLimits)
+{
+    table.NewSearch();
+    stop.store(false, std::memory_order_relaxed);
+
+    // lazy smp, helpers search the same root on their own copy and only share the table
+    const auto numThreads = kThreadsAvailable ? std::clamp(searchLimits.threads, 1, kMaxThreads) : 1;
+
+    std::vector<std::unique_ptr<Search>> helpers;
+    for (auto i = 1; i < numThreads; ++i)
+    {
+        helpers.push_back(std::make_unique<Search>(table));
+    }
+
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < helpers.size(); ++i)
+    {
+        threads.emplace_back([&, i]()
+                             { helpers[i]->Iterate(position, searchLimits, static_cast<int>(i) + 1); });
+    }
+
+    auto result = Iterate(position, searchLimits, 0);
+
+    for (auto& helper : helpers)
+    {
+        helper->Stop();
+    }
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+    for (const auto& helper : helpers)
+    {
+        result.nodes += helper->nodes;
+    }
+
+    return result;
+}
+
+const SearchResult Search::Iterate(const Chess& position, const SearchLimits& searchLimits, int threadIndex)
+{
+    limits = searchLimits;
+    start = std::chrono::steady_clock::now();
+    nodes = 0;
+
+    // killers belong to the old tree, history only fades
+    killers = {};
+    for (auto& color : history)
+    {
+        for (auto& from : color)
+        {
+            for (auto& entry : from)
+            {
+                entry /= 2;
+            }
+        }
+    }
+
+    Chess chess = position;
+
+    SearchResult result = {
+        .move = kNullMove,
+        .score = 0,
+        .depth = 0,
+        .nodes = 0,
+        .milliseconds = 0,
+    };
+
+    MoveList moves;
+    chess.Moves(moves);
+    if (moves.empty())
+    {
+        result.score = chess.InCheck(chess.GetTurn()) ? -kMateScore : 0;
+        return result;
+    }
+    result.move = moves[0];
+
+    const auto maxDepth = std::clamp(limits.depth, 1, kMaxSearchPly - 1);
+    auto score = 0;
+
+    // odd helpers start one ply deeper so the threads spread over two depths
+    for (auto depth = 1 + (threadIndex % 2); depth <= maxDepth; ++depth)
+    {
+        auto delta = kAspirationWindow;
+        auto alpha = -kInfinity;
+        auto beta = kInfinity;
+        if (depth >= 4)
+        {
+            alpha = std::max(score - delta, -kInfinity);
+            beta = std::min(score + delta, kInfinity);
+        }
+
+        while (true)
+        {
+            rootBest = result.move;
+            const auto value = Negamax(chess, depth, alpha, beta, 0);
+            if (stop.load(std::memory_order_relaxed))
+            {
+                break;
+            }
+
+            // widen the window on the side that failed and search again
+            if (value <= alpha)
+            {
+                beta = (alpha + beta) / 2;
+                alpha = std::max(value - delta, -kInfinity);
+            }
+            else if (value >= beta)
+            {
+                beta = std::min(value + delta, kInfinity);
+            }
+            else
+            {
+                score = value;
+                break;
+            }
+            delta *= 2;
+        }
+
+        if (stop.load(std::memory_order_relaxed))
+        {
+            break;
+        }
+
+        result.move = rootBest;
+        result.score = score;
+        result.depth = depth;
+
+        // a found mate won't get any shorter, and the next iteration wouldn't finish in time
+        if (std::abs(score) >= kMateScore - depth ||
+            (limits.milliseconds > 0 && Elapsed() * 2 >= limits.milliseconds))
+        {
+            break;
+        }
+    }
+
+    result.nodes = nodes;
+    result.milliseconds = Elapsed();
+    return result;
+}
+
+int Search::Negamax(Chess& chess, int depth, int alpha, int beta, int ply)
+{
+    const auto inCheck = chess.InCheck(chess.GetTurn());
+    if (inCheck)
+    {
+        ++depth;
+    }
+
+    if (depth <= 0)
+    {
+        return Quiescence(chess, alpha, beta, ply);
+    }
+
+    ++nodes;
+    if (ShouldStop())
+    {
+        return 0;
+    }
+
+    if (ply >= kMaxSearchPly - 1)
+    {
+        return Evaluate(chess);
+    }
+
+    // nothing below a known draw can change the score, and a repetition inside the
+    // search is as good as a draw since either side could repeat again
+    Wdl wdl;
+    if (ply > 0 && (chess.IsDraw(1) || (ProbeWdl(chess, wdl) && wdl == Wdl::Draw)))
+    {
+        return 0;
+    }
+
+    const auto pvNode = (beta - alpha) > 1;
+    const auto key = chess.GetHash();
+
+    Move ttMove = kNullMove;
+    TTEntry entry;
+    if (table.Probe(key, entry))
+    {
+        ttMove = entry.move;
+        if (ply > 0 && !pvNode && entry.depth >= depth)
+        {
+            const auto score = ScoreFromTT(entry.score, ply);
+            if (entry.bound == Bound::Exact ||
+                (entry.bound == Bound::Lower && score >= beta) ||
+                (entry.bound == Bound::Upper && score <= alpha))
+            {
+                return score;
+            }
+        }
+    }
+
+    const auto staticEval = inCheck ? -kInfinity : Evaluate(chess);
+    const auto originalAlpha = alpha;
+    auto best = -kInfinity;
+    auto bestMove = kNullMove;
+    auto played = 0;
+
+    MoveList quiets;
+    MovePicker picker(chess, ttMove, killers[ply], history);
+    for (auto move = picker.Next(); move != kNullMove; move = picker.Next())
+    {
+        chess.MakeMove(move);
+        int score;
+        if (played == 0)
+        {
+            score = -Negamax(chess, depth - 1, -beta, -alpha, ply + 1);
+        }
+        else
+        {
+            // principal variation search, prove the rest are worse with a null window
+            score = -Negamax(chess, depth - 1, -alpha - 1, -alpha, ply + 1);
+            if (score > alpha && score < beta)
+            {
+                score = -Negamax(chess, depth - 1, -beta, -alpha, ply + 1);
+            }
+        }
+        chess.UnmakeMove();
+        ++played;
+
+        if (stop.load(std::memory_order_relaxed))
+        {
+            return 0;
+        }
+
+        const auto quiet = !move.IsCapture() && !move.IsPromotion();
+        if (score > best)
+        {
+            best = score;
+            bestMove = move;
+            if (score > alpha)
+            {
+                alpha = score;
+                if (ply == 0)
+                {
+                    rootBest = move;
+                }
+                if (alpha >= beta)
+                {
+                    if (quiet)
+                    {
+                        UpdateQuietStats(chess.GetTurn(), move, quiets, depth, ply);
+                    }
+                    break;
+                }
+            }
+        }
+
+        if (quiet)
+        {
+            quiets.push_back(move);
+        }
+    }
+
+    if (played == 0)
+    {
+        return inCheck ? -kMateScore + ply : 0;
+    }
+
+    const auto bound = (best >= beta)             ? Bound::Lower
+                       : (best > originalAlpha)   ? Bound::Exact
+                                                  : Bound::Upper;
+    table.Store(key, bound == Bound::Upper ? kNullMove : bestMove, ScoreToTT(best, ply), staticEval, depth, bound);
+
+    return best;
+}
+
+int Search::Quiescence(Chess& chess, int alpha, int beta, int ply)
+{
+    ++nodes;
+    if (ShouldStop())
+    {
+        return 0;
+    }
+
+    const auto standPat = Evaluate(chess);
+    if (ply >= kMaxSearchPly - 1 || standPat >= beta)
+    {
+        return standPat;
+    }
+    alpha = std::max(alpha, standPat);
+
+    // only captures and promotions are searched past the horizon
+    auto best = standPat;
+    MovePicker picker(chess, kNullMove, history);
+    for (auto move = picker.Next(); move != kNullMove; move = picker.Next())
+    {
+        chess.MakeMove(move);
+        const auto score = -Quiescence(chess, -beta, -alpha, ply + 1);
+        chess.UnmakeMove();
+
+        if (stop.load(std::memory_order_relaxed))
+        {
+            return 0;
+        }
+
+        if (score > best)
+        {
+            best = score;
+            if (score > alpha)
+            {
+                alpha = score;
+                if (alpha >= beta)
+                {
+                    break;
+                }
+            }
+        }
+    }
+
+    return best;
+}
+
+int Search::Evaluate(const Chess& chess)
+{
+    Wdl wdl;
+    if (ProbeWdl(chess, wdl) && wdl == Wdl::Draw)
+    {
+        return 0;
+    }
+
+    if (const auto* network = chess.GetNetwork())
+    {
+        // an untrained network must not produce mate scores
+        return std::clamp(network->Evaluate(chess.GetAccumulator(), chess.GetTurn()), -kMateBound + 1, kMateBound - 1);
+    }
+
+    const auto& eval = chess.GetEval();
+    const auto& structure = pawns.Probe(chess);
+
+    const auto score = Taper(eval.GetMidgame() + structure.midgame, eval.GetEndgame() + structure.endgame, eval.GetPhase());
+    return chess.GetTurn() == PieceColor::White ? score : -score;
+}
+
+// the cutoff move is rewarded, the quiets tried before it are penalised
+void Search::UpdateQuietStats(PieceColor color, Move move, const MoveList& quiets, int depth, int ply)
+{
+    if (killers[ply][0] != move)
+    {
+        killers[ply][1] = killers[ply][0];
+        killers[ply][0] = move;
+    }
+
+    auto& table = history[static_cast<uint8_t>(color)];
+    const auto bonus = depth * depth;
+    UpdateHistory(table[move.From()][move.To()], bonus);
+    for (const auto& quiet : quiets)
+    {
+        UpdateHistory(table[quiet.From()][quiet.To()], -bonus);
+    }
+}
+
+bool Search::ShouldStop(void)
+{
+    if ((nodes & 1023) == 0 && limits.milliseconds > 0 && Elapsed() >= limits.milliseconds)
+    {
+        stop.store(true, std::memory_order_relaxed);
+    }
+    if (limits.nodes > 0 && nodes >= limits.nodes)
+    {
+        stop.store(true, std::memory_order_relaxed);
+    }
+    return stop.load(std::memory_order_relaxed);
+}
+
+int64_t Search::Elapsed(void) const
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+} // namespace chess
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+#include "chess.h"
+#include "movepicker.h"
+#include "pawns.h"
+#include "tt.h"
+
+namespace chess
+{
+
+constexpr const int kInfinity = 32001;
+constexpr const int kMateScore = 32000;
+constexpr const int kMateBound = kMateScore - kMaxSearchPly;
+constexpr const int kMaxThreads = 256;
+
+struct SearchLimits
+{
+    int depth = kMaxSearchPly - 1;
+    int64_t milliseconds = 0; // 0 is no time limit
+    uint64_t nodes = 0;       // 0 is no node limit, counted per thread
+    int threads = 1;
+};
+
+struct SearchResult
+{
+    Move move;
+    int score;
+    int depth;
+    uint64_t nodes;
+    int64_t milliseconds;
+};
+
+class Search
+{
+  public:
+    explicit Search(TranspositionTable& table);
+
+    const SearchResult Run(const Chess& position, const SearchLimits& limits);
+    void Stop(void) { stop.store(true, std::memory_order_relaxed); }
+
+  private:
+    const SearchResult Iterate(const Chess& position, const SearchLimits& searchLimits, int threadIndex);
+    int Negamax(Chess& chess, int depth, int alpha, int beta, int ply);
+    int Quiescence(Chess& chess, int alpha, int beta, int ply);
+    int Evaluate(const Chess& chess);
+
+    void UpdateQuietStats(PieceColor color, Move move, const MoveList& quiets, int depth, int ply);
+    bool ShouldStop(void);
+    int64_t Elapsed(void) const;
+
+  private:
+    TranspositionTable& table;
+    SearchLimits limits;
+    std::chrono::steady_clock::time_point start;
+    std::atomic<bool> stop;
+    uint64_t nodes;
+    Move rootBest;
+
+    std::array<Killers, kMaxSearchPly> killers;
+    HistoryTable history;
+    PawnTable pawns;
+};
+
+} // namespace chess
@@ -0,0 +1,230 @@
+#include "tablebase.h"
+#include "bitboard.h"
+
+#include <array>
+#include <mutex>
+#include <vector>
+
+namespace chess
+{
+
+namespace
+{
+
+// King and pawn against king, from the strong side's point of view with the pawn
+// moving up the board on files a-d. Indexed by side to move, both kings and the pawn
+// on ranks 2 to 7.
+constexpr const int kKpkSize = 2 * kNumSquares * kNumSquares * 4 * 6;
+
+enum KpkResult : uint8_t
+{
+    Invalid = 0,
+    Unknown = 1,
+    Draw = 2,
+    Win = 4,
+};
+
+constexpr int KpkIndex(int weakToMove, int strongKing, int weakKing, int pawn)
+{
+    const auto row = pawn / kNumFiles; // 1 is the 7th rank, 6 the 2nd
+    return weakToMove | (strongKing << 1) | (weakKing << 7) | ((pawn % kNumFiles) << 13) | ((row - 1) << 15);
+}
+
+constexpr bool Touches(int a, int b)
+{
+    return (KingMasks[a] & MaskFromSquare(b)) != 0;
+}
+
+KpkResult InitialResult(int weakToMove, int strongKing, int weakKing, int pawn)
+{
+    const auto promotion = pawn - kNumFiles;
+
+    if (strongKing == weakKing || Touches(strongKing, weakKing) || strongKing == pawn || weakKing == pawn ||
+        (!weakToMove && (WhitePawnCaptureMasks[pawn] & MaskFromSquare(weakKing))))
+    {
+        return Invalid;
+    }
+
+    // the pawn promotes and the queen can't be taken
+    if (!weakToMove && pawn / kNumFiles == 1 && strongKing != promotion && weakKing != promotion &&
+        (!Touches(weakKing, promotion) || Touches(strongKing, promotion)))
+    {
+        return Win;
+    }
+
+    // stalemate, or the pawn falls
+    const auto guarded = KingMasks[strongKing] | WhitePawnCaptureMasks[pawn];
+    if (weakToMove &&
+        ((KingMasks[weakKing] & ~guarded) == kEmptyBitboard ||
+         (KingMasks[weakKing] & MaskFromSquare(pawn) & ~KingMasks[strongKing])))
+    {
+        return Draw;
+    }
+
+    return Unknown;
+}
+
+KpkResult Classify(const std::vector<uint8_t>& db, int weakToMove, int strongKing, int weakKing, int pawn)
+{
+    uint8_t r = Invalid;
+
+    Bitboard moves = KingMasks[weakToMove ? weakKing : strongKing];
+    while (moves)
+    {
+        const auto to = MoveFromBitboard(moves);
+        moves &= moves - 1;
+        r |= weakToMove ? db[KpkIndex(0, strongKing, to, pawn)] : db[KpkIndex(1, to, weakKing, pawn)];
+    }
+
+    if (!weakToMove)
+    {
+        const auto row = pawn / kNumFiles;
+        if (row > 1)
+        {
+            r |= db[KpkIndex(1, strongKing, weakKing, pawn - kNumFiles)];
+        }
+        if (row == 6 && pawn - kNumFiles != strongKing && pawn - kNumFiles != weakKing)
+        {
+            r |= db[KpkIndex(1, strongKing, weakKing, pawn - 2 * kNumFiles)];
+        }
+    }
+
+    const auto good = weakToMove ? Draw : Win;
+    const auto bad = weakToMove ? Win : Draw;
+    return (r & good) ? good : (r & Unknown) ? Unknown : bad;
+}
+
+// one bit per position, set when the strong side wins
+std::array<uint64_t, kKpkSize / 64> kpkWins;
+std::once_flag kpkOnce;
+
+void BuildKpk(void)
+{
+    std::vector<uint8_t> db(kKpkSize);
+
+    for (auto weakToMove = 0; weakToMove < 2; ++weakToMove)
+    {
+        for (auto strongKing = 0; strongKing < kNumSquares; ++strongKing)
+        {
+            for (auto weakKing = 0; weakKing < kNumSquares; ++weakKing)
+            {
+                for (auto pawn = kNumFiles; pawn < kNumSquares - kNumFiles; ++pawn)
+                {
+                    if (pawn % kNumFiles < 4)
+                    {
+                        db[KpkIndex(weakToMove, strongKing, weakKing, pawn)] = InitialResult(weakToMove, strongKing, weakKing, pawn);
+                    }
+                }
+            }
+        }
+    }
+
+    // retrograde passes until nothing changes, whatever is left unknown is a draw
+    auto changed = true;
+    while (changed)
+    {
+        changed = false;
+        for (auto weakToMove = 0; weakToMove < 2; ++weakToMove)
+        {
+            for (auto strongKing = 0; strongKing < kNumSquares; ++strongKing)
+            {
+                for (auto weakKing = 0; weakKing < kNumSquares; ++weakKing)
+                {
+                    for (auto pawn = kNumFiles; pawn < kNumSquares - kNumFiles; ++pawn)
+                    {
+                        const auto index = KpkIndex(weakToMove, strongKing, weakKing, pawn);
+                        if (pawn % kNumFiles < 4 && db[index] == Unknown)
+                        {
+                            db[index] = Classify(db, weakToMove, strongKing, weakKing, pawn);
+                            changed |= db[index] != Unknown;
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    kpkWins.fill(0);
+    for (auto i = 0; i < kKpkSize; ++i)
+    {
+        if (db[i] == Win)
+        {
+            kpkWins[i / 64] |= 1ULL << (i % 64);
+        }
+    }
+}
+
+Wdl ProbeKpk(const Chess& chess, PieceColor strong)
+{
+    std::call_once(kpkOnce, BuildKpk);
+
+    const auto weak = strong == PieceColor::White ? PieceColor::Black : PieceColor::White;
+    auto strongKing = MoveFromBitboard(chess.GetPieces(strong, PieceType::King));
+    auto weakKing = MoveFromBitboard(chess.GetPieces(weak, PieceType::King));
+    auto pawn = MoveFromBitboard(chess.GetPieces(strong, PieceType::Pawn));
+
+    // black's pawn runs down the board, mirror it so it runs up
+    if (strong == PieceColor::Black)
+    {
+        strongKing ^= 56;
+        weakKing ^= 56;
+        pawn ^= 56;
+    }
+    if (pawn % kNumFiles >= 4)
+    {
+        strongKing ^= 7;
+        weakKing ^= 7;
+        pawn ^= 7;
+    }
+
+    const auto weakToMove = chess.GetTurn() == weak ? 1 : 0;
+    const auto index = KpkIndex(weakToMove, strongKing, weakKing, pawn);
+    if ((kpkWins[index / 64] >> (index % 64)) & 1)
+    {
+        return weakToMove ? Wdl::Loss : Wdl::Win;
+    }
+    return Wdl::Draw;
+}
+
+} // namespace
+
+bool ProbeWdl(const Chess& chess, Wdl& wdl)
+{
+    const auto pieces = [&chess](PieceType type)
+    {
+        return chess.GetPieces(PieceColor::White, type) | chess.GetPieces(PieceColor::Black, type);
+    };
+
+    const auto pawns = pieces(PieceType::Pawn);
+    const auto majors = pieces(PieceType::Rook) | pieces(PieceType::Queen);
+    const auto knights = pieces(PieceType::Knight);
+    const auto bishops = pieces(PieceType::Bishop);
+
+    if (majors != kEmptyBitboard)
+    {
+        return false;
+    }
+
+    if (pawns == kEmptyBitboard)
+    {
+        // a lone minor piece, or bishops that all share a square color, can never mate
+        if (CountPieces(knights | bishops) <= 1 ||
+            (knights == kEmptyBitboard && ((bishops & kLightSquares) == kEmptyBitboard || (bishops & ~kLightSquares) == kEmptyBitboard)))
+        {
+            wdl = Wdl::Draw;
+            return true;
+        }
+        return false;
+    }
+
+    if (CountPieces(pawns) == 1 && (knights | bishops) == kEmptyBitboard)
+    {
+        const auto strong = chess.GetPieces(PieceColor::White, PieceType::Pawn) ? PieceColor::White : PieceColor::Black;
+        wdl = ProbeKpk(chess, strong);
+        return true;
+    }
+
+    return false;
+}
+
+} // namespace chess
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <cstdint>
+
+#include "chess.h"
+
+namespace chess
+{
+
+// the result with best play, for the side to move
+enum class Wdl : int8_t
+{
+    Loss = -1,
+    Draw = 0,
+    Win = 1,
+};
+
+// Exact results for the endings that need no files: positions where neither
+// side can ever mate, and king and pawn against king through a bitbase that
+// is built on first use. False when the position isn't covered.
+bool ProbeWdl(const Chess& chess, Wdl& wdl);
+
+} // namespace chess
@@ -0,0 +1,395 @@
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "chess/chess.h"
+#include "chess/search.h"
+
+namespace
+{
+
+enum class Format
+{
+    Csv,
+    Json,
+};
+
+struct Options
+{
+    std::string input = "-";
+    std::string output = "-";
+    Format format = Format::Csv;
+    int depth = 0;
+    uint64_t nodes = 0;
+    int threads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    size_t hash = 4; // megabytes per worker, cleared for every position
+};
+
+struct Job
+{
+    uint64_t index;
+    std::string line;
+};
+
+struct Position
+{
+    std::string fen;
+    std::string id;
+};
+
+// EPD is the first four FEN fields followed by "opcode operand;" operations,
+// plain FEN lines with the two clocks are accepted as well
+std::optional<Position> ParseEPD(const std::string& line)
+{
+    std::istringstream stream(line);
+
+    std::string fields[4];
+    for (auto& field : fields)
+    {
+        if (!(stream >> field))
+        {
+            return std::nullopt;
+        }
+    }
+
+    Position position;
+    position.fen = fields[0] + " " + fields[1] + " " + fields[2] + " " + fields[3];
+
+    std::string rest;
+    std::getline(stream, rest);
+
+    // the id operation names the position in the output
+    const auto id = rest.find("id ");
+    if (id != std::string::npos)
+    {
+        const auto open = rest.find('"', id);
+        const auto close = (open == std::string::npos) ? std::string::npos : rest.find('"', open + 1);
+        if (close != std::string::npos)
+        {
+            position.id = rest.substr(open + 1, close - open - 1);
+        }
+    }
+
+    return position;
+}
+
+// quotes a value for CSV or JSON output
+const std::string Escape(const std::string& value, Format format)
+{
+    std::string escaped = "\"";
+    for (const auto c : value)
+    {
+        if (c == '"')
+        {
+            escaped += (format == Format::Csv) ? "\"\"" : "\\\"";
+        }
+        else if (c == '\\' && format == Format::Json)
+        {
+            escaped += "\\\\";
+        }
+        else
+        {
+            escaped += c;
+        }
+    }
+    return escaped + "\"";
+}
+
+class Worker
+{
+  public:
+    explicit Worker(const Options& options) : options(options), table(options.hash) {}
+
+    const std::string Analyze(const Job& job)
+    {
+        const auto position = ParseEPD(job.line);
+        if (!position)
+        {
+            return Row(job.index, "", job.line, nullptr, "invalid EPD");
+        }
+
+        chess::Chess chess;
+        const auto error = chess.Load(position->fen);
+        if (error != chess::FenError::None)
+        {
+            return Row(job.index, position->id, position->fen, nullptr,
+                       std::string("invalid position: ") + chess::GetFenErrorMessage(error));
+        }
+
+        // a fresh table keeps every result independent of the order and thread it ran on
+        table.Clear();
+        chess::Search search(table);
+        const auto result = search.Run(chess, chess::SearchLimits{
+                                                  .depth = options.depth > 0 ? options.depth : chess::kMaxSearchPly - 1,
+                                                  .nodes = options.nodes,
+                                              });
+        return Row(job.index, position->id, position->fen, &result, "");
+    }
+
+  private:
+    const std::string Row(uint64_t index, const std::string& id, const std::string& fen,
+                          const chess::SearchResult* result, const std::string& error) const
+    {
+        const auto format = options.format;
+        const auto move = result ? chess::MoveToUCI(result->move) : std::string();
+
+        char buffer[256];
+        if (format == Format::Csv)
+        {
+            std::snprintf(buffer, sizeof(buffer), ",%s,%d,%d,%llu,%lld,",
+                          move.c_str(),
+                          result ? result->score : 0,
+                          result ? result->depth : 0,
+                          static_cast<unsigned long long>(result ? result->nodes : 0),
+                          static_cast<long long>(result ? result->milliseconds : 0));
+            return std::to_string(index) + "," + Escape(id, format) + "," + Escape(fen, format) + buffer +
+                   Escape(error, format) + "\n";
+        }
+
+        std::snprintf(buffer, sizeof(buffer), ",\"move\":\"%s\",\"score\":%d,\"depth\":%d,\"nodes\":%llu,\"ms\":%lld",
+                      move.c_str(),
+                      result ? result->score : 0,
+                      result ? result->depth : 0,
+                      static_cast<unsigned long long>(result ? result->nodes : 0),
+                      static_cast<long long>(result ? result->milliseconds : 0));
+        return "{\"index\":" + std::to_string(index) + ",\"id\":" + Escape(id, format) + ",\"fen\":" +
+               Escape(fen, format) + buffer + ",\"error\":" + Escape(error, format) + "}\n";
+    }
+
+  private:
+    const Options& options;
+    chess::TranspositionTable table;
+};
+
+// Reads positions into a bounded queue, workers analyze them and the results are
+// written back in input order, so memory stays flat however long the file is.
+class Pipeline
+{
+  public:
+    Pipeline(const Options& options, std::istream& in, std::ostream& out)
+        : options(options), in(in), out(out), done(false), nextWrite(0)
+    {
+    }
+
+    uint64_t Run(void)
+    {
+        std::vector<std::thread> workers;
+        for (auto i = 0; i < options.threads; ++i)
+        {
+            workers.emplace_back([this]()
+                                 { Work(); });
+        }
+
+        uint64_t index = 0;
+        std::string line;
+        while (std::getline(in, line))
+        {
+            if (!line.empty() && line.back() == '\r')
+            {
+                line.pop_back();
+            }
+            if (line.empty() || line[0] == '#')
+            {
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock(mutex);
+            notFull.wait(lock, [this]()
+                         { return jobs.size() + pending.size() < kMaxQueued; });
+            jobs.push_back(Job{index++, std::move(line)});
+            notEmpty.notify_one();
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            done = true;
+        }
+        notEmpty.notify_all();
+
+        for (auto& worker : workers)
+        {
+            worker.join();
+        }
+        return index;
+    }
+
+  private:
+    static constexpr size_t kMaxQueued = 4096;
+
+    void Work(void)
+    {
+        Worker worker(options);
+
+        while (true)
+        {
+            Job job;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                notEmpty.wait(lock, [this]()
+                              { return done || !jobs.empty(); });
+                if (jobs.empty())
+                {
+                    return;
+                }
+                job = std::move(jobs.front());
+                jobs.pop_front();
+            }
+
+            auto row = worker.Analyze(job);
+
+            std::lock_guard<std::mutex> lock(mutex);
+            pending.emplace(job.index, std::move(row));
+            while (!pending.empty() && pending.begin()->first == nextWrite)
+            {
+                out << pending.begin()->second;
+                pending.erase(pending.begin());
+                ++nextWrite;
+            }
+            notFull.notify_one();
+        }
+    }
+
+  private:
+    const Options& options;
+    std::istream& in;
+    std::ostream& out;
+
+    std::mutex mutex;
+    std::condition_variable notEmpty;
+    std::condition_variable notFull;
+    std::deque<Job> jobs;
+    std::map<uint64_t, std::string> pending; // finished out of order
+    bool done;
+    uint64_t nextWrite;
+};
+
+void Usage(const char* exe)
+{
+    std::fprintf(stderr,
+                 "usage: %s [--depth N] [--nodes N] [--threads N] [--hash MB] [--format csv|json] [--output file] [input.epd]\n"
+                 "       reads stdin when no input is given, json writes one object per line\n",
+                 exe);
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    Options options;
+
+    for (auto i = 1; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "--depth") == 0 && i + 1 < argc)
+        {
+            options.depth = std::atoi(argv[++i]);
+        }
+        else if (std::strcmp(argv[i], "--nodes") == 0 && i + 1 < argc)
+        {
+            options.nodes = std::strtoull(argv[++i], nullptr, 10);
+        }
+        else if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+        {
+            options.threads = std::max(1, std::atoi(argv[++i]));
+        }
+        else if (std::strcmp(argv[i], "--hash") == 0 && i + 1 < argc)
+        {
+            options.hash = std::strtoull(argv[++i], nullptr, 10);
+        }
+        else if (std::strcmp(argv[i], "--format") == 0 && i + 1 < argc)
+        {
+            ++i;
+            if (std::strcmp(argv[i], "csv") == 0)
+            {
+                options.format = Format::Csv;
+            }
+            else if (std::strcmp(argv[i], "json") == 0)
+            {
+                options.format = Format::Json;
+            }
+            else
+            {
+                Usage(argv[0]);
+                return EXIT_FAILURE;
+            }
+        }
+        else if (std::strcmp(argv[i], "--output") == 0 && i + 1 < argc)
+        {
+            options.output = argv[++i];
+        }
+        else if (argv[i][0] != '-' || std::strcmp(argv[i], "-") == 0)
+        {
+            options.input = argv[i];
+        }
+        else
+        {
+            Usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    // without a limit every position would search to the maximum depth
+    if (options.depth <= 0 && options.nodes == 0)
+    {
+        options.depth = 8;
+    }
+
+    std::ifstream file;
+    if (options.input != "-")
+    {
+        file.open(options.input);
+        if (!file)
+        {
+            std::fprintf(stderr, "cannot open %s\n", options.input.c_str());
+            return EXIT_FAILURE;
+        }
+    }
+
+    std::ofstream output;
+    if (options.output != "-")
+    {
+        output.open(options.output);
+        if (!output)
+        {
+            std::fprintf(stderr, "cannot write %s\n", options.output.c_str());
+            return EXIT_FAILURE;
+        }
+    }
+
+    std::istream& in = file.is_open() ? static_cast<std::istream&>(file) : std::cin;
+    std::ostream& out = output.is_open() ? static_cast<std::ostream&>(output) : std::cout;
+
+    std::ios::sync_with_stdio(false);
+
+    if (options.format == Format::Csv)
+    {
+        out << "index,id,fen,move,score,depth,nodes,ms,error\n";
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    Pipeline pipeline(options, in, out);
+    const auto count = pipeline.Run();
+    out.flush();
+
+    const auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::fprintf(stderr, "%llu positions in %.3fs (%.1f/s) on %d thread(s)\n",
+                 static_cast<unsigned long long>(count),
+                 elapsed,
+                 elapsed > 0.0 ? count / elapsed : 0.0,
+                 options.threads);
+
+    return EXIT_SUCCESS;
+}
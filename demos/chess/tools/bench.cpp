@@ -0,0 +1,676 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "chess/book.h"
+#include "chess/chess.h"
+#include "chess/nnue.h"
+#include "chess/perft.h"
+#include "chess/san.h"
+#include "chess/search.h"
+#include "chess/tablebase.h"
+
+namespace
+{
+
+struct BenchPosition
+{
+    const char* name;
+    const char* fen;
+    int depth;
+    std::vector<uint64_t> expected; // expected[d - 1] is perft(d)
+};
+
+// https://www.chessprogramming.org/Perft_Results
+const std::vector<BenchPosition> kPositions = {
+    {"startpos", "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1", 5, {20, 400, 8902, 197281, 4865609, 119060324}},
+    {"kiwipete", "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1", 4, {48, 2039, 97862, 4085603, 193690690}},
+    {"position3", "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1", 5, {14, 191, 2812, 43238, 674624, 11030083}},
+    {"position4", "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1", 4, {6, 264, 9467, 422333, 15833292}},
+    {"position5", "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8", 4, {44, 1486, 62379, 2103487, 89941194}},
+    {"position6", "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10", 4, {46, 2079, 89890, 3894594, 164075551}},
+    // https://www.chessprogramming.org/Chess960_Perft_Results, castling written as X-FEN
+    {"frc1", "bqnb1rkr/pp3ppp/3ppn2/2p5/5P2/P2P4/NPP1P1PP/BQ1BNRKR w KQkq - 2 9", 4, {21, 528, 12189, 326672, 8146062}},
+    {"frc2", "b1q1rrkb/pppppppp/3nn3/8/P7/1PPP4/4PPPP/BQNNRKRB w KQ - 1 9", 4, {20, 479, 10471, 273318, 6417013}},
+    {"frc3", "qbbnnrkr/2pp2pp/p7/1p2pp2/8/P3PP2/1PPP1KPP/QBBNNR1R w kq - 0 9", 4, {22, 593, 13440, 382958, 9183776}},
+    {"frc4", "1nbbnrkr/p1p1ppp1/3p4/1p3P1p/3Pq2P/8/PPP1P1P1/QNBBNRKR w KQkq - 0 9", 4, {28, 1120, 31058, 1171749, 34030312}},
+    {"frc5", "qnbnr1kr/ppp1b1pp/4p3/3p1p2/8/2NPP3/PPP1BPPP/QNB1R1KR w KQkq - 1 9", 4, {29, 899, 26578, 824055, 24851983}},
+};
+
+// set by --nnue, searches use the classical evaluation otherwise
+std::unique_ptr<chess::Network> network;
+
+void Usage(const char* exe)
+{
+    std::fprintf(stderr,
+                 "usage: %s [--depth N] [--threads N] [--hash MB]\n"
+                 "       %s [--threads N] [--hash MB] --divide N <fen>\n"
+                 "       %s --search N [--ms N] [--threads N] [--nnue <file>]\n"
+                 "       %s --nnue-check\n"
+                 "       %s --fen-check\n"
+                 "       %s --book <book.bin> [fen]\n"
+                 "       %s --tablebase-check\n"
+                 "       %s --draw-check\n",
+                 exe, exe, exe, exe, exe, exe, exe, exe);
+}
+
+// perft over the root moves, split across threads and cached when there is a table
+uint64_t CountPerft(chess::Chess& chess, int depth, chess::PerftTable* table, int threads)
+{
+    uint64_t nodes = 0;
+    for (const auto& entry : chess::Divide(chess, depth, table, threads))
+    {
+        nodes += entry.nodes;
+    }
+    return nodes;
+}
+
+int RunDivide(int depth, const std::string& fen, chess::PerftTable* table, int threads)
+{
+    chess::Chess chess;
+    const auto error = chess.Load(fen);
+    if (error != chess::FenError::None)
+    {
+        std::fprintf(stderr, "invalid fen: %s\n", chess::GetFenErrorMessage(error));
+        return EXIT_FAILURE;
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    const auto divide = chess::Divide(chess, depth, table, threads);
+    const auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    uint64_t total = 0;
+    for (const auto& entry : divide)
+    {
+        std::printf("%s: %llu\n",
+                    chess::MoveToUCI(entry.move).c_str(),
+                    static_cast<unsigned long long>(entry.nodes));
+        total += entry.nodes;
+    }
+
+    std::printf("\nmoves: %zu\nnodes: %llu\ntime: %.3fs\n",
+                divide.size(),
+                static_cast<unsigned long long>(total),
+                elapsed);
+    return 0;
+}
+
+int RunSuite(int maxDepth, chess::PerftTable* table, int threads)
+{
+    auto failures = 0;
+    uint64_t totalNodes = 0;
+    double totalTime = 0.0;
+
+    std::printf("%-10s %5s %12s %12s %10s %14s  %s\n", "position", "depth", "nodes", "expected", "time", "nps", "result");
+
+    for (const auto& position : kPositions)
+    {
+        const auto depth = (maxDepth > 0) ? std::min<int>(maxDepth, position.expected.size()) : position.depth;
+
+        chess::Chess chess;
+        chess.Load(position.fen);
+
+        const auto start = std::chrono::steady_clock::now();
+        const auto nodes = (table || threads > 1) ? CountPerft(chess, depth, table, threads) : chess::Perft(chess, depth);
+        const auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        const auto expected = position.expected[depth - 1];
+        const auto ok = (nodes == expected);
+        failures += ok ? 0 : 1;
+        totalNodes += nodes;
+        totalTime += elapsed;
+
+        std::printf("%-10s %5d %12llu %12llu %9.3fs %14.0f  %s\n",
+                    position.name,
+                    depth,
+                    static_cast<unsigned long long>(nodes),
+                    static_cast<unsigned long long>(expected),
+                    elapsed,
+                    elapsed > 0.0 ? nodes / elapsed : 0.0,
+                    ok ? "ok" : "FAIL");
+    }
+
+    std::printf("\ntotal: %llu nodes in %.3fs (%.0f nps), %d failure(s)\n",
+                static_cast<unsigned long long>(totalNodes),
+                totalTime,
+                totalTime > 0.0 ? totalNodes / totalTime : 0.0,
+                failures);
+
+    return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+int RunSearch(int depth, int64_t milliseconds, int threads)
+{
+    chess::TranspositionTable table;
+    uint64_t totalNodes = 0;
+    double totalTime = 0.0;
+
+    std::printf("%-10s %5s %8s %6s %12s %10s %14s\n", "position", "depth", "move", "score", "nodes", "time", "nps");
+
+    for (const auto& position : kPositions)
+    {
+        chess::Chess chess;
+        chess.Load(position.fen);
+        chess.SetNetwork(network.get());
+
+        table.Clear();
+        chess::Search search(table);
+        const auto result = search.Run(chess, chess::SearchLimits{
+                                                  .depth = depth,
+                                                  .milliseconds = milliseconds,
+                                                  .threads = threads,
+                                              });
+
+        const auto elapsed = result.milliseconds / 1000.0;
+        totalNodes += result.nodes;
+        totalTime += elapsed;
+
+        std::printf("%-10s %5d %8s %6d %12llu %9.3fs %14.0f\n",
+                    position.name,
+                    result.depth,
+                    chess::MoveToUCI(result.move).c_str(),
+                    result.score,
+                    static_cast<unsigned long long>(result.nodes),
+                    elapsed,
+                    elapsed > 0.0 ? result.nodes / elapsed : 0.0);
+    }
+
+    std::printf("\ntotal: %llu nodes in %.3fs (%.0f nps)\n",
+                static_cast<unsigned long long>(totalNodes),
+                totalTime,
+                totalTime > 0.0 ? totalNodes / totalTime : 0.0);
+    return EXIT_SUCCESS;
+}
+
+// random weights in the file format, layer 1 uses the full int8 range to stress the SIMD dot product
+const std::vector<uint8_t> RandomNetwork(uint32_t seed)
+{
+    std::mt19937 rng(seed);
+    std::vector<uint8_t> bytes;
+    bytes.reserve(chess::kNetworkFileSize);
+
+    auto write = [&](auto value)
+    {
+        const auto* raw = reinterpret_cast<const uint8_t*>(&value);
+        bytes.insert(bytes.end(), raw, raw + sizeof(value));
+    };
+    auto random = [&](int lo, int hi)
+    {
+        return std::uniform_int_distribution<int>(lo, hi)(rng);
+    };
+
+    for (const auto value : {chess::kNetworkMagic, chess::kNetworkVersion,
+                             static_cast<uint32_t>(chess::kNetworkHidden), static_cast<uint32_t>(chess::kNetworkLayer1)})
+    {
+        write(value);
+    }
+    for (auto i = 0; i < chess::kNetworkHidden; ++i)
+    {
+        write(static_cast<int16_t>(random(-32, 96)));
+    }
+    for (auto i = 0; i < chess::kNetworkFeatures * chess::kNetworkHidden; ++i)
+    {
+        write(static_cast<int16_t>(random(-24, 24)));
+    }
+    for (auto i = 0; i < chess::kNetworkLayer1; ++i)
+    {
+        write(static_cast<int32_t>(random(-4096, 4096)));
+    }
+    for (auto i = 0; i < chess::kNetworkLayer1 * 2 * chess::kNetworkHidden; ++i)
+    {
+        write(static_cast<int8_t>(random(-128, 127)));
+    }
+    write(static_cast<int32_t>(random(-4096, 4096)));
+    for (auto i = 0; i < chess::kNetworkLayer1; ++i)
+    {
+        write(static_cast<int8_t>(random(-128, 127)));
+    }
+    return bytes;
+}
+
+// plays random games from every bench position and checks the SIMD score against the scalar
+// one and the incrementally updated accumulator against a fresh one
+int RunNetworkCheck(int plies)
+{
+    const auto bytes = RandomNetwork(2025);
+    auto random = std::make_unique<chess::Network>();
+    if (!random->Load(bytes.data(), bytes.size()))
+    {
+        std::fprintf(stderr, "failed to load the generated network\n");
+        return EXIT_FAILURE;
+    }
+
+    std::mt19937 rng(1);
+    uint64_t checked = 0;
+    uint64_t mismatches = 0;
+    uint64_t checksum = 0; // the same in every build, SIMD or not
+
+    for (const auto& position : kPositions)
+    {
+        chess::Chess chess;
+        chess.Load(position.fen);
+        chess.SetNetwork(random.get());
+
+        for (auto ply = 0; ply < plies; ++ply)
+        {
+            chess::Chess fresh = chess;
+            fresh.SetNetwork(random.get());
+
+            const auto& accumulator = chess.GetAccumulator();
+            for (const auto side : {chess::PieceColor::White, chess::PieceColor::Black})
+            {
+                const auto simd = random->Evaluate(accumulator, side);
+                const auto scalar = random->EvaluateScalar(accumulator, side);
+                const auto refreshed = random->EvaluateScalar(fresh.GetAccumulator(), side);
+                if (simd != scalar || scalar != refreshed)
+                {
+                    ++mismatches;
+                    std::printf("%s ply %d: simd %d scalar %d refreshed %d\n", position.name, ply, simd, scalar, refreshed);
+                }
+                checksum = checksum * 31 + static_cast<uint32_t>(simd);
+                ++checked;
+            }
+
+            chess::MoveList moves;
+            chess.Moves(moves);
+            if (moves.empty())
+            {
+                break;
+            }
+            chess.MakeMove(moves[std::uniform_int_distribution<size_t>(0, moves.size() - 1)(rng)]);
+        }
+    }
+
+    std::printf("nnue: %llu evaluations, checksum %016llx, %llu mismatch(es)\n",
+                static_cast<unsigned long long>(checked),
+                static_cast<unsigned long long>(checksum),
+                static_cast<unsigned long long>(mismatches));
+    return mismatches == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+int RunBook(const std::string& path, const std::string& fen)
+{
+    chess::Book book;
+    if (!book.Open(path))
+    {
+        std::fprintf(stderr, "failed to open book %s\n", path.c_str());
+        return EXIT_FAILURE;
+    }
+
+    chess::Chess chess;
+    const auto error = chess.Load(fen);
+    if (error != chess::FenError::None)
+    {
+        std::fprintf(stderr, "invalid fen: %s\n", chess::GetFenErrorMessage(error));
+        return EXIT_FAILURE;
+    }
+
+    chess::BookMove moves[chess::kMaxBookMoves];
+    const auto count = book.Probe(chess, moves, chess::kMaxBookMoves);
+
+    std::printf("key %016llx, %zu book move(s) of %zu entries\n",
+                static_cast<unsigned long long>(chess.GetPolyglotKey()), count, book.GetSize());
+    for (size_t i = 0; i < count; ++i)
+    {
+        char san[chess::kMaxSanLength];
+        chess::WriteSAN(chess, moves[i].move, san);
+        std::printf("%-8s %6u\n", san, moves[i].weight);
+    }
+    return EXIT_SUCCESS;
+}
+
+// the result of a position one move after promoting, with the weak side to move
+chess::Wdl PromotedResult(chess::Chess& chess)
+{
+    chess::Wdl wdl;
+    if (chess::ProbeWdl(chess, wdl))
+    {
+        return wdl;
+    }
+
+    chess::MoveList moves;
+    chess.Moves(moves);
+    if (moves.empty())
+    {
+        return chess.InCheck(chess.GetTurn()) ? chess::Wdl::Loss : chess::Wdl::Draw;
+    }
+    for (const auto& move : moves)
+    {
+        if (move.IsCapture())
+        {
+            return chess::Wdl::Draw;
+        }
+    }
+    return chess::Wdl::Loss;
+}
+
+// every king and pawn against king position must agree with the best of its children,
+// found with the real move generator, so the bitbase is checked against the board
+int RunTablebaseCheck(void)
+{
+    uint64_t checked = 0;
+    uint64_t mismatches = 0;
+    uint64_t wins = 0;
+
+    for (const auto strong : {chess::PieceColor::White, chess::PieceColor::Black})
+    {
+        const auto weak = strong == chess::PieceColor::White ? chess::PieceColor::Black : chess::PieceColor::White;
+        for (const auto turn : {chess::PieceColor::White, chess::PieceColor::Black})
+        {
+            for (uint8_t pawn = chess::kNumFiles; pawn < chess::kNumSquares - chess::kNumFiles; ++pawn)
+            {
+                for (uint8_t strongKing = 0; strongKing < chess::kNumSquares; ++strongKing)
+                {
+                    for (uint8_t weakKing = 0; weakKing < chess::kNumSquares; ++weakKing)
+                    {
+                        if (strongKing == weakKing || strongKing == pawn || weakKing == pawn)
+                        {
+                            continue;
+                        }
+
+                        chess::Chess chess;
+                        chess.Clear();
+                        chess.PutPiece(chess::MakePiece(strong, chess::PieceType::King), strongKing);
+                        chess.PutPiece(chess::MakePiece(weak, chess::PieceType::King), weakKing);
+                        chess.PutPiece(chess::MakePiece(strong, chess::PieceType::Pawn), pawn);
+                        chess.SetTurn(turn);
+                        if (chess.InCheck(chess.GetOpponent()))
+                        {
+                            continue;
+                        }
+
+                        chess::MoveList moves;
+                        chess.Moves(moves);
+                        auto expected = chess.InCheck(turn) ? chess::Wdl::Loss : chess::Wdl::Draw;
+                        for (auto i = 0; i < static_cast<int>(moves.size()); ++i)
+                        {
+                            if (i == 0)
+                            {
+                                expected = chess::Wdl::Loss;
+                            }
+                            chess.MakeMove(moves[i]);
+                            chess::Wdl child;
+                            if (moves[i].IsPromotion())
+                            {
+                                child = PromotedResult(chess);
+                            }
+                            else
+                            {
+                                chess::ProbeWdl(chess, child);
+                            }
+                            chess.UnmakeMove();
+                            expected = std::max(expected, static_cast<chess::Wdl>(-static_cast<int>(child)));
+                        }
+
+                        chess::Wdl wdl;
+                        chess::ProbeWdl(chess, wdl);
+                        if (wdl != expected && mismatches++ < 10)
+                        {
+                            std::printf("%s: %d, expected %d\n", chess.GetFEN().c_str(), static_cast<int>(wdl), static_cast<int>(expected));
+                        }
+                        wins += wdl != chess::Wdl::Draw ? 1 : 0;
+                        ++checked;
+                    }
+                }
+            }
+        }
+    }
+
+    std::printf("tablebase: %llu positions, %llu decisive, %llu mismatch(es)\n",
+                static_cast<unsigned long long>(checked),
+                static_cast<unsigned long long>(wins),
+                static_cast<unsigned long long>(mismatches));
+    return mismatches == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+// FENs the parser has to turn down, with the reason it should give
+const std::vector<std::pair<const char*, chess::FenError>> kBadFens = {
+    {"", chess::FenError::Placement},
+    {"rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP w KQkq - 0 1", chess::FenError::Placement},
+    {"rnbqkbnr/pppppppp/44/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1", chess::FenError::Placement},
+    {"rnbqkbnr/pppppppp/9/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1", chess::FenError::Placement},
+    {"rnbqkbnr/ppppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1", chess::FenError::Placement},
+    {"rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNX w KQkq - 0 1", chess::FenError::Placement},
+    {"rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR x KQkq - 0 1", chess::FenError::SideToMove},
+    {"rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkqK - 0 1", chess::FenError::Castling},
+    {"rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBN1 w KQkq - 0 1", chess::FenError::Castling},
+    {"rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq e3 0 1", chess::FenError::EnPassant},
+    {"rnbqkbnr/pppppppp/8/8/4P3/8/PPPP1PPP/RNBQKBNR b KQkq e4 0 1", chess::FenError::EnPassant},
+    {"rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - x 1", chess::FenError::HalfmoveClock},
+    {"rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0", chess::FenError::FullmoveNumber},
+    {"rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 0", chess::FenError::FullmoveNumber},
+    {"rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1 x", chess::FenError::TrailingInput},
+    {"8/8/8/8/8/8/8/8 w - - 0 1", chess::FenError::Kings},
+    {"kk6/8/8/8/8/8/8/K7 w - - 0 1", chess::FenError::Kings},
+    {"k7/8/8/8/8/8/8/K6P w - - 0 1", chess::FenError::Pawns},
+    {"k6R/8/8/8/8/8/8/K7 w - - 0 1", chess::FenError::OpponentInCheck},
+    {"4k3/8/8/8/8/8/8/4K2R w G - 0 1", chess::FenError::Castling},
+    {"4k3/8/8/8/8/8/4K3/7R w K - 0 1", chess::FenError::Castling},
+    {"4k3/8/8/8/8/8/8/R3K2R w HKQ - 0 1", chess::FenError::Castling},
+};
+
+// Shredder-FEN castling is read and written back as KQkq when the rook is the outermost one
+const std::vector<std::pair<const char*, const char*>> kChess960Fens = {
+    {"bqnb1rkr/pp3ppp/3ppn2/2p5/5P2/P2P4/NPP1P1PP/BQ1BNRKR w HFhf - 2 9", "bqnb1rkr/pp3ppp/3ppn2/2p5/5P2/P2P4/NPP1P1PP/BQ1BNRKR w KQkq - 2 9"},
+    {"rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w HAha - 0 1", "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1"},
+    {"1k2r2r/8/8/8/8/8/8/1K2R2R w Ee - 0 1", "1k2r2r/8/8/8/8/8/8/1K2R2R w Ee - 0 1"},
+};
+
+// loads every bad FEN and checks that random games from the bench positions survive
+// a trip through GetFEN and Load with the same hash, clocks and FEN
+int RunFenCheck(int plies)
+{
+    auto failures = 0;
+
+    for (const auto& [fen, expected] : kBadFens)
+    {
+        chess::Chess chess;
+        const auto error = chess.Load(fen);
+        if (error != expected || chess.GetFEN() != chess::kDefaultPosition)
+        {
+            ++failures;
+            std::printf("\"%s\": %s, expected %s\n", fen, chess::GetFenErrorMessage(error), chess::GetFenErrorMessage(expected));
+        }
+    }
+
+    for (const auto& [fen, expected] : kChess960Fens)
+    {
+        chess::Chess chess;
+        if (chess.Load(fen) != chess::FenError::None || chess.GetFEN() != expected)
+        {
+            ++failures;
+            std::printf("\"%s\": wrote %s, expected %s\n", fen, chess.GetFEN().c_str(), expected);
+        }
+    }
+
+    std::mt19937 rng(1);
+    uint64_t checked = 0;
+
+    for (const auto& position : kPositions)
+    {
+        chess::Chess chess;
+        chess.Load(position.fen);
+        if (chess.GetFEN() != position.fen)
+        {
+            ++failures;
+            std::printf("%s: wrote %s\n", position.name, chess.GetFEN().c_str());
+        }
+
+        for (auto ply = 0; ply < plies; ++ply)
+        {
+            const auto fen = chess.GetFEN();
+            chess::Chess loaded;
+            if (loaded.Load(fen) != chess::FenError::None || loaded.GetFEN() != fen || loaded.GetHash() != chess.GetHash())
+            {
+                ++failures;
+                std::printf("%s ply %d: %s does not round trip\n", position.name, ply, fen.c_str());
+            }
+            ++checked;
+
+            chess::MoveList moves;
+            chess.Moves(moves);
+            if (moves.empty())
+            {
+                break;
+            }
+            chess.MakeMove(moves[std::uniform_int_distribution<size_t>(0, moves.size() - 1)(rng)]);
+        }
+    }
+
+    std::printf("fen: %zu rejected, %zu Chess960, %llu round trips, %d failure(s)\n",
+                kBadFens.size(),
+                kChess960Fens.size(),
+                static_cast<unsigned long long>(checked),
+                failures);
+    return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+struct DrawCase
+{
+    const char* fen;
+    std::vector<const char*> moves; // SAN, played in order
+    bool twofold;                   // IsDraw(1) after the moves
+    bool threefold;                 // IsDraw() after the moves
+};
+
+const std::vector<DrawCase> kDrawCases = {
+    {"rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1", {"Nf3", "Nf6", "Ng1"}, false, false},
+    {"rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1", {"Nf3", "Nf6", "Ng1", "Ng8"}, true, false},
+    {"rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1", {"Nf3", "Nf6", "Ng1", "Ng8", "Nf3", "Nf6", "Ng1", "Ng8"}, true, true},
+    // the pawn move in between makes every later position new
+    {"rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1", {"Nf3", "Nf6", "Ng1", "Ng8", "e3", "Nf6", "Nf3", "Ng8"}, false, false},
+    // the same squares with a different side to move is a different position
+    {"4k3/8/8/8/8/8/8/R3K3 w - - 0 1", {"Ra2", "Kd8", "Ra3", "Ke8", "Ra1"}, false, false},
+    {"4k3/8/8/8/8/8/8/R3K3 w - - 98 60", {"Ra2"}, false, false},
+    {"4k3/8/8/8/8/8/8/R3K3 w - - 99 60", {"Ra2"}, true, true},
+    // mate on the hundredth ply stands
+    {"6k1/5ppp/8/8/8/8/8/R3K3 w - - 99 60", {"Ra8#"}, false, false},
+};
+
+// plays short move sequences and checks repetition and fifty-move draws
+int RunDrawCheck(void)
+{
+    auto failures = 0;
+
+    for (const auto& draw : kDrawCases)
+    {
+        chess::Chess chess;
+        if (chess.Load(draw.fen) != chess::FenError::None)
+        {
+            ++failures;
+            std::printf("%s: invalid FEN\n", draw.fen);
+            continue;
+        }
+
+        for (const auto* san : draw.moves)
+        {
+            const auto move = chess::ParseSAN(chess, san);
+            if (move == chess::kNullMove)
+            {
+                ++failures;
+                std::printf("%s: illegal move %s\n", draw.fen, san);
+                break;
+            }
+            chess.MakeMove(move);
+        }
+
+        if (chess.IsDraw(1) != draw.twofold || chess.IsDraw() != draw.threefold)
+        {
+            ++failures;
+            std::printf("%s after %zu move(s): draw %d/%d, expected %d/%d\n", draw.fen, draw.moves.size(),
+                        chess.IsDraw(1), chess.IsDraw(), draw.twofold, draw.threefold);
+        }
+    }
+
+    std::printf("draw: %zu case(s), %d failure(s)\n", kDrawCases.size(), failures);
+    return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    auto depth = 0;
+    auto searchDepth = 0;
+    int64_t milliseconds = 0;
+    auto threads = 1;
+    std::unique_ptr<chess::PerftTable> perftTable;
+
+    for (auto i = 1; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "--depth") == 0 && i + 1 < argc)
+        {
+            depth = std::atoi(argv[++i]);
+        }
+        else if (std::strcmp(argv[i], "--search") == 0 && i + 1 < argc)
+        {
+            searchDepth = std::atoi(argv[++i]);
+        }
+        else if (std::strcmp(argv[i], "--ms") == 0 && i + 1 < argc)
+        {
+            milliseconds = std::atoll(argv[++i]);
+        }
+        else if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+        {
+            threads = std::atoi(argv[++i]);
+        }
+        else if (std::strcmp(argv[i], "--hash") == 0 && i + 1 < argc)
+        {
+            const auto megabytes = std::strtoull(argv[++i], nullptr, 10);
+            perftTable = megabytes > 0 ? std::make_unique<chess::PerftTable>(megabytes) : nullptr;
+        }
+        else if (std::strcmp(argv[i], "--nnue") == 0 && i + 1 < argc)
+        {
+            network = std::make_unique<chess::Network>();
+            if (!network->LoadFile(argv[++i]))
+            {
+                std::fprintf(stderr, "failed to load network %s\n", argv[i]);
+                return EXIT_FAILURE;
+            }
+        }
+        else if (std::strcmp(argv[i], "--nnue-check") == 0)
+        {
+            return RunNetworkCheck(200);
+        }
+        else if (std::strcmp(argv[i], "--draw-check") == 0)
+        {
+            return RunDrawCheck();
+        }
+        else if (std::strcmp(argv[i], "--tablebase-check") == 0)
+        {
+            return RunTablebaseCheck();
+        }
+        else if (std::strcmp(argv[i], "--fen-check") == 0)
+        {
+            return RunFenCheck(200);
+        }
+        else if (std::strcmp(argv[i], "--book") == 0 && i + 1 < argc)
+        {
+            return RunBook(argv[i + 1], i + 2 < argc ? argv[i + 2] : chess::kDefaultPosition);
+        }
+        else if (std::strcmp(argv[i], "--divide") == 0 && i + 2 < argc)
+        {
+            const auto divideDepth = std::atoi(argv[i + 1]);
+            return RunDivide(divideDepth, argv[i + 2], perftTable.get(), threads);
+        }
+        else
+        {
+            Usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (searchDepth > 0 || milliseconds > 0)
+    {
+        return RunSearch(searchDepth > 0 ? searchDepth : chess::kMaxSearchPly - 1, milliseconds, threads);
+    }
+
+    return RunSuite(depth, perftTable.get(), threads);
+}
@@ -0,0 +1,272 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "chess/book.h"
+#include "chess/chess.h"
+#include "chess/mapped.h"
+#include "chess/pgn.h"
+#include "chess/san.h"
+
+namespace
+{
+
+struct Options
+{
+    std::vector<std::string> inputs;
+    size_t chunk = 0; // 0 feeds each mapped file at once
+    bool check = false;
+    std::string book;
+    int bookPlies = 20;
+};
+
+// counts games and results, and with --check replays every game on a second board
+// to see that each move writes back to SAN that decodes to the same move
+class Stats : public chess::PgnVisitor
+{
+  public:
+    Stats(bool check, int bookPlies) : check(check), bookPlies(bookPlies), ply(0) {}
+
+    void OnGameStart(void) override
+    {
+        ply = 0;
+        if (check)
+        {
+            replay.Reset();
+        }
+    }
+
+    void OnTag(std::string_view name, std::string_view value) override
+    {
+        if (check && name == "FEN")
+        {
+            replay.Load(value);
+        }
+    }
+
+    void OnMove(const chess::Chess& chess, chess::Move move) override
+    {
+        ++plies;
+        if (ply++ < bookPlies)
+        {
+            ++book[{chess.GetPolyglotKey(), chess::EncodeBookMove(move)}];
+        }
+        if (!check)
+        {
+            return;
+        }
+
+        char san[chess::kMaxSanLength];
+        chess::WriteSAN(replay, move, san);
+        if (replay.GetHash() != chess.GetHash() || chess::ParseSAN(replay, san) != move)
+        {
+            ++mismatches;
+            std::fprintf(stderr, "game %llu: %s does not round trip in %s\n",
+                         static_cast<unsigned long long>(games + 1), san, replay.GetFEN().c_str());
+        }
+        replay.MakeMove(move);
+    }
+
+    void OnGameEnd(const chess::Chess& chess, std::string_view result, chess::PgnStatus status) override
+    {
+        (void)chess;
+        ++games;
+        ++statuses[static_cast<uint8_t>(status)];
+        if (result == "1-0")
+        {
+            ++whiteWins;
+        }
+        else if (result == "0-1")
+        {
+            ++blackWins;
+        }
+        else if (result == "1/2-1/2")
+        {
+            ++draws;
+        }
+        else
+        {
+            ++unfinished;
+        }
+    }
+
+    uint64_t games = 0;
+    uint64_t plies = 0;
+    uint64_t whiteWins = 0;
+    uint64_t blackWins = 0;
+    uint64_t draws = 0;
+    uint64_t unfinished = 0;
+    uint64_t statuses[4] = {};
+    uint64_t mismatches = 0;
+
+    // how often each move was played from each position, sorted the way the book file is
+    std::map<std::pair<uint64_t, uint16_t>, uint32_t> book;
+
+  private:
+    bool check;
+    int bookPlies;
+    int ply;
+    chess::Chess replay;
+};
+
+bool WriteBook(const std::string& path, const std::map<std::pair<uint64_t, uint16_t>, uint32_t>& entries)
+{
+    std::ofstream file(path, std::ios::binary);
+    if (!file)
+    {
+        return false;
+    }
+
+    for (const auto& [position, count] : entries)
+    {
+        const auto weight = std::min<uint32_t>(count, 0xFFFF);
+        uint8_t entry[chess::kBookEntrySize] = {};
+        for (auto i = 0; i < 8; ++i)
+        {
+            entry[i] = static_cast<uint8_t>(position.first >> (56 - 8 * i));
+        }
+        entry[8] = static_cast<uint8_t>(position.second >> 8);
+        entry[9] = static_cast<uint8_t>(position.second);
+        entry[10] = static_cast<uint8_t>(weight >> 8);
+        entry[11] = static_cast<uint8_t>(weight);
+        file.write(reinterpret_cast<const char*>(entry), sizeof(entry));
+    }
+    return static_cast<bool>(file);
+}
+
+bool Import(const std::string& input, size_t chunk, chess::PgnReader& reader, uint64_t& bytes)
+{
+    if (input == "-")
+    {
+        std::vector<char> buffer(chunk > 0 ? chunk : 1 << 20);
+        size_t read = 0;
+        while ((read = std::fread(buffer.data(), 1, buffer.size(), stdin)) > 0)
+        {
+            reader.Feed(buffer.data(), read);
+            bytes += read;
+        }
+        return true;
+    }
+
+    chess::MappedFile file;
+    if (!file.Open(input, true))
+    {
+        std::fprintf(stderr, "cannot open %s\n", input.c_str());
+        return false;
+    }
+
+    const auto* data = reinterpret_cast<const char*>(file.GetData());
+    const auto size = file.GetSize();
+    const auto step = chunk > 0 ? chunk : std::max<size_t>(size, 1);
+    for (size_t offset = 0; offset < size; offset += step)
+    {
+        reader.Feed(data + offset, std::min(step, size - offset));
+    }
+    bytes += size;
+    return true;
+}
+
+void Usage(const char* exe)
+{
+    std::fprintf(stderr,
+                 "usage: %s [--chunk BYTES] [--check] [--book out.bin [--book-plies N]] <games.pgn>...\n"
+                 "       reads stdin for -, games spanning several files are not joined\n"
+                 "       --book writes a Polyglot book of the moves played in the first plies\n",
+                 exe);
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    Options options;
+
+    for (auto i = 1; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "--chunk") == 0 && i + 1 < argc)
+        {
+            options.chunk = std::strtoull(argv[++i], nullptr, 10);
+        }
+        else if (std::strcmp(argv[i], "--check") == 0)
+        {
+            options.check = true;
+        }
+        else if (std::strcmp(argv[i], "--book") == 0 && i + 1 < argc)
+        {
+            options.book = argv[++i];
+        }
+        else if (std::strcmp(argv[i], "--book-plies") == 0 && i + 1 < argc)
+        {
+            options.bookPlies = std::atoi(argv[++i]);
+        }
+        else if (argv[i][0] != '-' || std::strcmp(argv[i], "-") == 0)
+        {
+            options.inputs.push_back(argv[i]);
+        }
+        else
+        {
+            Usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (options.inputs.empty())
+    {
+        Usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    Stats stats(options.check, options.book.empty() ? 0 : options.bookPlies);
+    chess::PgnReader reader(stats);
+    uint64_t bytes = 0;
+
+    const auto start = std::chrono::steady_clock::now();
+    for (const auto& input : options.inputs)
+    {
+        if (!Import(input, options.chunk, reader, bytes))
+        {
+            return EXIT_FAILURE;
+        }
+        reader.Finish();
+    }
+    const auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::printf("games: %llu (1-0 %llu, 0-1 %llu, 1/2 %llu, * %llu)\n",
+                static_cast<unsigned long long>(stats.games),
+                static_cast<unsigned long long>(stats.whiteWins),
+                static_cast<unsigned long long>(stats.blackWins),
+                static_cast<unsigned long long>(stats.draws),
+                static_cast<unsigned long long>(stats.unfinished));
+    std::printf("plies: %llu\n", static_cast<unsigned long long>(stats.plies));
+    std::printf("errors: %llu invalid fen, %llu illegal move, %llu too long\n",
+                static_cast<unsigned long long>(stats.statuses[static_cast<uint8_t>(chess::PgnStatus::InvalidFen)]),
+                static_cast<unsigned long long>(stats.statuses[static_cast<uint8_t>(chess::PgnStatus::IllegalMove)]),
+                static_cast<unsigned long long>(stats.statuses[static_cast<uint8_t>(chess::PgnStatus::TooLong)]));
+    std::printf("time: %.3fs (%.1f MB/s, %.0f plies/s)\n",
+                elapsed,
+                elapsed > 0.0 ? bytes / elapsed / 1e6 : 0.0,
+                elapsed > 0.0 ? stats.plies / elapsed : 0.0);
+    if (!options.book.empty())
+    {
+        if (!WriteBook(options.book, stats.book))
+        {
+            std::fprintf(stderr, "cannot write %s\n", options.book.c_str());
+            return EXIT_FAILURE;
+        }
+        std::printf("book: %zu entries in %s\n", stats.book.size(), options.book.c_str());
+    }
+    if (options.check)
+    {
+        std::printf("check: %llu mismatch(es)\n", static_cast<unsigned long long>(stats.mismatches));
+    }
+
+    return stats.mismatches == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
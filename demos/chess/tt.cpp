@@ -0,0 +1,170 @@
+#include "tt.h"
+
+#include <algorithm>
+#include <bit>
+#include <limits>
+
+namespace chess
+{
+
+namespace
+{
+
+// move (16) | score (16) | eval (16) | depth (8) | bound (2) | generation (6)
+constexpr uint64_t Pack(const TTEntry& entry)
+{
+    return static_cast<uint64_t>(entry.move.data) |
+           (static_cast<uint64_t>(static_cast<uint16_t>(entry.score)) << 16) |
+           (static_cast<uint64_t>(static_cast<uint16_t>(entry.eval)) << 32) |
+           (static_cast<uint64_t>(static_cast<uint8_t>(entry.depth)) << 48) |
+           (static_cast<uint64_t>(entry.bound) << 56) |
+           (static_cast<uint64_t>(entry.generation & 0x3F) << 58);
+}
+
+constexpr TTEntry Unpack(uint64_t data)
+{
+    TTEntry entry = {};
+    entry.move.data = static_cast<uint16_t>(data);
+    entry.score = static_cast<int16_t>(data >> 16);
+    entry.eval = static_cast<int16_t>(data >> 32);
+    entry.depth = static_cast<int8_t>(data >> 48);
+    entry.bound = static_cast<Bound>((data >> 56) & 0x3);
+    entry.generation = static_cast<uint8_t>(data >> 58);
+    return entry;
+}
+
+constexpr uint8_t kGenerationMask = 0x3F;
+
+} // namespace
+
+TranspositionTable::TranspositionTable(size_t megabytes)
+{
+    Resize(megabytes);
+}
+
+void TranspositionTable::Resize(size_t megabytes)
+{
+    // round down to a power of two so the index is a mask
+    const auto bytes = std::max<size_t>(megabytes, 1) * 1024 * 1024;
+    const auto count = std::bit_floor(bytes / sizeof(Bucket));
+
+    buckets = std::vector<Bucket>(count);
+    mask = count - 1;
+    Clear();
+}
+
+void TranspositionTable::Clear(void)
+{
+    for (auto& bucket : buckets)
+    {
+        for (auto& slot : bucket.slots)
+        {
+            slot.key.store(0, std::memory_order_relaxed);
+            slot.data.store(0, std::memory_order_relaxed);
+        }
+    }
+    generation = 0;
+}
+
+void TranspositionTable::NewSearch(void)
+{
+    generation = (generation + 1) & kGenerationMask;
+}
+
+bool TranspositionTable::Probe(uint64_t key, TTEntry& entry) const
+{
+    const auto& bucket = GetBucket(key);
+    for (const auto& slot : bucket.slots)
+    {
+        const auto data = slot.data.load(std::memory_order_relaxed);
+        if ((slot.key.load(std::memory_order_relaxed) ^ data) == key && data != 0)
+        {
+            entry = Unpack(data);
+            return true;
+        }
+    }
+    return false;
+}
+
+void TranspositionTable::Store(uint64_t key, Move move, int score, int eval, int depth, Bound bound)
+{
+    auto& bucket = GetBucket(key);
+
+    // prefer the slot holding this position, then the shallowest / oldest one
+    Slot* replace = &bucket.slots[0];
+    auto replaceWorth = std::numeric_limits<int>::max();
+    TTEntry previous = {};
+
+    for (auto& slot : bucket.slots)
+    {
+        const auto data = slot.data.load(std::memory_order_relaxed);
+        const auto entry = Unpack(data);
+        if ((slot.key.load(std::memory_order_relaxed) ^ data) == key || data == 0)
+        {
+            replace = &slot;
+            previous = entry;
+            break;
+        }
+
+        const auto age = (generation - entry.generation) & kGenerationMask;
+        const auto worth = entry.depth - 4 * age;
+        if (worth < replaceWorth)
+        {
+            replace = &slot;
+            replaceWorth = worth;
+            previous = {};
+        }
+    }
+
+    // keep a deeper result for the same position unless this one is exact
+    if (previous.bound != Bound::None && bound != Bound::Exact &&
+        previous.generation == generation && depth + 2 < previous.depth)
+    {
+        return;
+    }
+
+    // don't lose the best move on a fail-low that has none
+    if (move.data == 0)
+    {
+        move = previous.move;
+    }
+
+    const auto data = Pack(TTEntry{
+        .move = move,
+        .score = static_cast<int16_t>(score),
+        .eval = static_cast<int16_t>(eval),
+        .depth = static_cast<int8_t>(depth),
+        .bound = bound,
+        .generation = generation,
+    });
+
+    replace->key.store(key ^ data, std::memory_order_relaxed);
+    replace->data.store(data, std::memory_order_relaxed);
+}
+
+void TranspositionTable::Prefetch(uint64_t key) const
+{
+#if defined(__GNUC__) || defined(__clang__)
+    __builtin_prefetch(&GetBucket(key));
+#else
+    (void)key;
+#endif
+}
+
+int TranspositionTable::Hashfull(void) const
+{
+    // sample the first thousand buckets
+    const auto samples = std::min<size_t>(buckets.size(), 1000);
+    auto used = 0;
+    for (size_t i = 0; i < samples; ++i)
+    {
+        for (const auto& slot : buckets[i].slots)
+        {
+            const auto data = slot.data.load(std::memory_order_relaxed);
+            used += (data != 0 && Unpack(data).generation == generation) ? 1 : 0;
+        }
+    }
+    return samples == 0 ? 0 : static_cast<int>(used * 1000 / (samples * kBucketSize));
+}
+
+} // namespace chess
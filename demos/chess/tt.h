@@ -0,0 +1,74 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "move.h"
+
+namespace chess
+{
+
+constexpr const size_t kDefaultTTSize = 16; // megabytes
+
+enum class Bound : uint8_t
+{
+    None = 0,
+    Upper = 1, // failed low, score is at most this
+    Lower = 2, // failed high, score is at least this
+    Exact = 3,
+};
+
+struct TTEntry
+{
+    Move move;
+    int16_t score;
+    int16_t eval;
+    int8_t depth;
+    Bound bound;
+    uint8_t generation;
+};
+
+// Shared, lock-free transposition table. Every slot keeps (key ^ data, data),
+// so a slot torn by two threads writing at once fails verification on probe
+// instead of handing back another position's data.
+class TranspositionTable
+{
+  public:
+    explicit TranspositionTable(size_t megabytes = kDefaultTTSize);
+
+    void Resize(size_t megabytes);
+    void Clear(void);
+    void NewSearch(void);
+
+    bool Probe(uint64_t key, TTEntry& entry) const;
+    void Store(uint64_t key, Move move, int score, int eval, int depth, Bound bound);
+    void Prefetch(uint64_t key) const;
+
+    size_t GetSize(void) const { return buckets.size() * sizeof(Bucket); }
+    int Hashfull(void) const;
+
+  private:
+    static constexpr int kBucketSize = 4;
+
+    struct Slot
+    {
+        std::atomic<uint64_t> key;
+        std::atomic<uint64_t> data;
+    };
+
+    struct alignas(64) Bucket
+    {
+        Slot slots[kBucketSize];
+    };
+
+    inline const Bucket& GetBucket(uint64_t key) const { return buckets[key & mask]; }
+    inline Bucket& GetBucket(uint64_t key) { return buckets[key & mask]; }
+
+    std::vector<Bucket> buckets;
+    uint64_t mask;
+    uint8_t generation;
+};
+
+} // namespace chess
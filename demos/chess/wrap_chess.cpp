@@ -1,34 +1,302 @@
 #include <emscripten/bind.h>
+#include <memory>
+#include <random>
 
+#include "book.h"
 #include "chess.h"
+#include "pgn.h"
+#include "san.h"
+#include "search.h"
+#include "tablebase.h"
 
 namespace chess
 {
 
 emscripten::val w_getMoves(Chess& self, emscripten::val opts)
 {
-    std::vector<Move> moves = {};
+    MoveList moves;
 
     if (opts.isUndefined() || opts.isNull())
     {
-        moves = self.Moves();
+        self.Moves(moves);
     }
     else if (opts.hasOwnProperty("square"))
     {
         auto square = opts["square"].as<uint8_t>();
-        moves = self.MovesFromSquare(square);
+        self.MovesFromSquare(square, moves);
     }
     else if (opts.hasOwnProperty("piece"))
     {
         auto piece = opts["piece"].as<uint8_t>();
-        moves = self.MovesForPiece(piece);
+        self.MovesForPiece(piece, moves);
     }
     else
     {
         throw std::invalid_argument("Invalid moves() argument");
     }
 
-    return emscripten::val::array(moves);
+    return emscripten::val::array(std::vector<Move>(moves.begin(), moves.end()));
+}
+
+uint8_t w_getMoveFrom(const Move& move)
+{
+    return move.From();
+}
+
+void w_setMoveFrom(Move& move, uint8_t from)
+{
+    move = Move(from, move.To(), move.Flag());
+}
+
+uint8_t w_getMoveTo(const Move& move)
+{
+    return move.To();
+}
+
+void w_setMoveTo(Move& move, uint8_t to)
+{
+    move = Move(move.From(), to, move.Flag());
+}
+
+uint8_t w_getMoveFlags(const Move& move)
+{
+    return static_cast<uint8_t>(move.Flag());
+}
+
+void w_setMoveFlags(Move& move, uint8_t flags)
+{
+    move = Move(move.From(), move.To(), static_cast<MoveFlag>(flags));
+}
+
+bool w_move(Chess& self, uint8_t from, uint8_t to)
+{
+    return self.MovePiece(from, to);
+}
+
+bool w_playMove(Chess& self, const Move& move)
+{
+    return self.MovePiece(move);
+}
+
+emscripten::val w_getSAN(Chess& self, const Move& move)
+{
+    if (!self.IsLegal(move))
+    {
+        return emscripten::val::null();
+    }
+
+    char san[kMaxSanLength];
+    WriteSAN(self, move, san);
+    return emscripten::val(std::string(san));
+}
+
+emscripten::val w_parseSAN(Chess& self, const std::string& san)
+{
+    const auto move = ParseSAN(self, san);
+    if (move == kNullMove)
+    {
+        return emscripten::val::null();
+    }
+    return emscripten::val(move);
+}
+
+// counts the games of a collection that JS hands over in chunks, e.g. from File.stream()
+class PgnImport : public PgnVisitor
+{
+  public:
+    PgnImport() : reader(*this) {}
+
+    void Feed(emscripten::val bytes)
+    {
+        const auto data = emscripten::convertJSArrayToNumberVector<uint8_t>(bytes);
+        reader.Feed(reinterpret_cast<const char*>(data.data()), data.size());
+    }
+
+    void Finish(void) { reader.Finish(); }
+
+    emscripten::val GetStats(void) const
+    {
+        auto stats = emscripten::val::object();
+        stats.set("games", static_cast<double>(games));
+        stats.set("plies", static_cast<double>(plies));
+        stats.set("errors", static_cast<double>(errors));
+        stats.set("whiteWins", static_cast<double>(whiteWins));
+        stats.set("blackWins", static_cast<double>(blackWins));
+        stats.set("draws", static_cast<double>(draws));
+        return stats;
+    }
+
+    void OnMove(const Chess& chess, Move move) override
+    {
+        (void)chess;
+        (void)move;
+        ++plies;
+    }
+
+    void OnGameEnd(const Chess& chess, std::string_view result, PgnStatus status) override
+    {
+        (void)chess;
+        ++games;
+        errors += status != PgnStatus::Ok ? 1 : 0;
+        whiteWins += result == "1-0" ? 1 : 0;
+        blackWins += result == "0-1" ? 1 : 0;
+        draws += result == "1/2-1/2" ? 1 : 0;
+    }
+
+  private:
+    uint64_t games = 0;
+    uint64_t plies = 0;
+    uint64_t errors = 0;
+    uint64_t whiteWins = 0;
+    uint64_t blackWins = 0;
+    uint64_t draws = 0;
+    PgnReader reader;
+};
+
+TranspositionTable& w_getTable(void)
+{
+    static TranspositionTable table;
+    return table;
+}
+
+Book& w_getBook(void)
+{
+    static Book book;
+    return book;
+}
+
+// bytes of a Polyglot book, an empty array unloads it
+bool w_loadBook(emscripten::val bytes)
+{
+    const auto data = emscripten::convertJSArrayToNumberVector<uint8_t>(bytes);
+    if (data.empty())
+    {
+        w_getBook().Close();
+        return true;
+    }
+    return w_getBook().Load(data.data(), data.size());
+}
+
+emscripten::val w_bestMove(Chess& self, emscripten::val opts)
+{
+    SearchLimits limits = {};
+
+    // book moves skip the search unless { book: false } asks for one
+    if (opts.isUndefined() || opts.isNull() || !opts.hasOwnProperty("book") || opts["book"].as<bool>())
+    {
+        static std::mt19937 rng(std::random_device{}());
+        const auto move = w_getBook().Pick(self, rng());
+        if (move != kNullMove)
+        {
+            return emscripten::val(move);
+        }
+    }
+
+    if (opts.isUndefined() || opts.isNull())
+    {
+        limits.milliseconds = 100;
+    }
+    else
+    {
+        if (opts.hasOwnProperty("depth"))
+        {
+            limits.depth = opts["depth"].as<int>();
+        }
+        if (opts.hasOwnProperty("ms"))
+        {
+            limits.milliseconds = opts["ms"].as<int>();
+        }
+        if (opts.hasOwnProperty("threads"))
+        {
+            limits.threads = opts["threads"].as<int>();
+        }
+        if (!opts.hasOwnProperty("depth") && !opts.hasOwnProperty("ms"))
+        {
+            throw std::invalid_argument("Invalid bestMove() argument");
+        }
+    }
+
+    Search search(w_getTable());
+    const auto result = search.Run(self, limits);
+    if (result.move == kNullMove)
+    {
+        return emscripten::val::null();
+    }
+    return emscripten::val(result.move);
+}
+
+PawnTable& w_getPawnTable(void)
+{
+    static PawnTable pawns;
+    return pawns;
+}
+
+// null when the position was loaded, otherwise why the FEN was rejected
+emscripten::val w_load(Chess& self, const std::string& fen)
+{
+    const auto error = self.Load(fen);
+    if (error != FenError::None)
+    {
+        return emscripten::val(std::string(GetFenErrorMessage(error)));
+    }
+    return emscripten::val::null();
+}
+
+// threefold repetition or the fifty-move rule
+bool w_isDraw(Chess& self)
+{
+    return self.IsDraw();
+}
+
+// "win", "draw" or "loss" for the side to move, null when the position isn't covered
+emscripten::val w_probeWdl(Chess& self)
+{
+    Wdl wdl;
+    if (!ProbeWdl(self, wdl))
+    {
+        return emscripten::val::null();
+    }
+    return emscripten::val(wdl == Wdl::Win ? "win" : wdl == Wdl::Loss ? "loss" : "draw");
+}
+
+// bytes of a network file, an empty array goes back to the classical evaluation
+emscripten::val w_loadNetwork(Chess& self, emscripten::val bytes)
+{
+    static auto network = std::make_unique<Network>();
+
+    const auto data = emscripten::convertJSArrayToNumberVector<uint8_t>(bytes);
+    if (data.empty())
+    {
+        self.SetNetwork(nullptr);
+        return emscripten::val(true);
+    }
+    if (!network->Load(data.data(), data.size()))
+    {
+        return emscripten::val(false);
+    }
+    self.SetNetwork(network.get());
+    return emscripten::val(true);
+}
+
+// white's point of view, cheap enough to read every frame
+emscripten::val w_getEval(Chess& self)
+{
+    const auto& eval = self.GetEval();
+    const auto& structure = w_getPawnTable().Probe(self);
+
+    const auto midgame = eval.GetMidgame() + structure.midgame;
+    const auto endgame = eval.GetEndgame() + structure.endgame;
+
+    auto result = emscripten::val::object();
+    result.set("score", Taper(midgame, endgame, eval.GetPhase()));
+    result.set("midgame", midgame);
+    result.set("endgame", endgame);
+    result.set("phase", eval.GetPhase());
+    if (const auto* network = self.GetNetwork())
+    {
+        result.set("score", network->Evaluate(self.GetAccumulator(), PieceColor::White));
+    }
+    return result;
 }
 
 emscripten::val w_getCastlingRights(Chess& self)
@@ -80,8 +348,9 @@ EMSCRIPTEN_BINDINGS(chess_module)
     emscripten::register_vector<Move>("MoveList");
 
     emscripten::value_object<Move>("Move")
-        .field("from", &Move::from)
-        .field("to", &Move::to);
+        .field("from", &w_getMoveFrom, &w_setMoveFrom)
+        .field("to", &w_getMoveTo, &w_setMoveTo)
+        .field("flags", &w_getMoveFlags, &w_setMoveFlags);
 
     emscripten::class_<Chess>("Chess")
         .constructor<>()
@@ -104,19 +373,36 @@ EMSCRIPTEN_BINDINGS(chess_module)
         .function("setCastlingRights", &Chess::SetCastlingRights)
 
         .function("moves", w_getMoves)
+        .function("san", w_getSAN)
+        .function("parseSan", w_parseSAN)
+        .function("bestMove", w_bestMove)
+        .function("eval", w_getEval)
+        .function("loadNetwork", w_loadNetwork)
 
         .function("attacking", w_getAttacking)
         .function("inCheck", w_getInCheck)
         .function("isCheckmate", &Chess::InCheckmate)
+        .function("isDraw", w_isDraw)
+        .function("tablebase", w_probeWdl)
 
         .function("board", &Chess::GetBoard)
         .function("clear", &Chess::Clear)
-        .function("load", &Chess::Load)
-        .function("move", &Chess::MovePiece)
+        .function("load", w_load)
+        .function("fen", &Chess::GetFEN)
+        .function("move", w_move)
+        .function("playMove", w_playMove)
         .function("put", &Chess::PutPiece)
         .function("remove", &Chess::RemovePiece)
         .function("reset", &Chess::Reset);
 
+    emscripten::function("loadBook", &w_loadBook);
+
+    emscripten::class_<PgnImport>("PgnImport")
+        .constructor<>()
+        .function("feed", &PgnImport::Feed)
+        .function("finish", &PgnImport::Finish)
+        .function("stats", &PgnImport::GetStats);
+
     emscripten::register_vector<uint8_t>("VectorUint8");
     emscripten::register_vector<int>("VectorInt");
 }
@@ -70,7 +70,7 @@ constexpr uint64_t ComputeZobristHash(const Piece board[kNumSquares],
     {
         if (board[sq] != static_cast<uint8_t>(PieceType::None))
         {
-            hash ^= zobrist.psq[board[sq] - 1][sq]; // -1 because EMPTY=0
+            hash ^= zobrist.psq[GetPieceIndex(board[sq])][sq];
         }
     }
 
@@ -89,4 +89,97 @@ constexpr uint64_t ComputeZobristHash(const Piece board[kNumSquares],
     return hash;
 }
 
+// only the pawns, keys the pawn structure cache
+constexpr uint64_t ComputeZobristPawnHash(const Piece board[kNumSquares])
+{
+    uint64_t hash = 0;
+
+    for (auto sq = 0; sq < kNumSquares; ++sq)
+    {
+        if (GetPieceType(board[sq]) == PieceType::Pawn)
+        {
+            hash ^= zobrist.psq[GetPieceIndex(board[sq])][sq];
+        }
+    }
+
+    return hash;
+}
+
+// Polyglot book keys: 12 piece kinds x 64 squares, then castling, en passant files and the side to move.
+// The layout follows the Polyglot spec, the values come from SplitMix64 like the table above.
+// Books made by other programs only match once the spec's published Random64 values are put here.
+constexpr const int kPolyglotCastlingOffset = kNumPieces * kNumSquares;
+constexpr const int kPolyglotEnPassantOffset = kPolyglotCastlingOffset + 4;
+constexpr const int kPolyglotTurnOffset = kPolyglotEnPassantOffset + kNumFiles;
+constexpr const int kPolyglotNumKeys = kPolyglotTurnOffset + 1;
+
+struct PolyglotZobrist
+{
+    std::array<uint64_t, kPolyglotNumKeys> random;
+
+    constexpr PolyglotZobrist(void) : random{}
+    {
+        SplitMix64 rng(kPolyglotNumKeys);
+
+        for (auto& key : random)
+        {
+            key = rng.next();
+        }
+    }
+};
+
+constexpr PolyglotZobrist polyglot = PolyglotZobrist();
+
+// black pawn, white pawn, black knight, ... white king, on squares counted from a1
+constexpr int PolyglotPieceKey(Piece piece, uint8_t square)
+{
+    const auto kind = 2 * (static_cast<int>(GetPieceType(piece)) - 1) + (GetPieceColor(piece) == PieceColor::White ? 1 : 0);
+    return kind * kNumSquares + (square ^ 56);
+}
+
+constexpr uint64_t ComputePolyglotKey(const Piece board[kNumSquares],
+                                      const PieceColor turn,
+                                      const CastlingRights castlingRights,
+                                      uint8_t epSquare)
+{
+    uint64_t key = 0;
+
+    for (auto sq = 0; sq < kNumSquares; ++sq)
+    {
+        if (board[sq] != static_cast<uint8_t>(PieceType::None))
+        {
+            key ^= polyglot.random[PolyglotPieceKey(board[sq], sq)];
+        }
+    }
+
+    constexpr CastlingRights kRights[] = {CastlingRights::WhiteKingSide, CastlingRights::WhiteQueenSide,
+                                          CastlingRights::BlackKingSide, CastlingRights::BlackQueenSide};
+    for (auto i = 0; i < 4; ++i)
+    {
+        if (Has(castlingRights, kRights[i]))
+        {
+            key ^= polyglot.random[kPolyglotCastlingOffset + i];
+        }
+    }
+
+    // only when a pawn of the side to move stands next to the one that just moved two squares
+    if (epSquare != kNullSquare)
+    {
+        const auto file = epSquare % kNumFiles;
+        const auto pushed = (turn == PieceColor::White) ? epSquare + kNumFiles : epSquare - kNumFiles;
+        const auto pawn = MakePiece(turn, PieceType::Pawn);
+        if ((file > 0 && board[pushed - 1] == pawn) || (file < kNumFiles - 1 && board[pushed + 1] == pawn))
+        {
+            key ^= polyglot.random[kPolyglotEnPassantOffset + file];
+        }
+    }
+
+    if (turn == PieceColor::White)
+    {
+        key ^= polyglot.random[kPolyglotTurnOffset];
+    }
+
+    return key;
+}
+
 } // namespace chess
\ No newline at end of file